@@ -0,0 +1,61 @@
+/**
+ * @file ActivityTracker.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "ActivityTracker.h"
+#include "ComponentStore.h"
+#include "Component.h"
+
+/**
+ * Check every component for rest after a physics step
+ * and put the ones at rest for two steps to sleep.
+ * @param components The components of the machine
+ */
+void ActivityTracker::Update(const ComponentStore& components)
+{
+    auto& all = components.GetComponents();
+    if(mResting.size() != all.size())
+    {
+        mResting.assign(all.size(), false);
+    }
+
+    mActiveCount = 0;
+    mSleepingCount = 0;
+    for(size_t i=0; i<all.size(); i++)
+    {
+        auto component = all[i];
+        auto resting = component->IsResting();
+        auto asleep = resting && mResting[i];
+        component->SetAsleep(asleep);
+        mResting[i] = resting;
+
+        if(asleep)
+        {
+            mSleepingCount++;
+        }
+        else
+        {
+            mActiveCount++;
+        }
+    }
+}
+
+/**
+ * Wake every component, so each has to be at rest
+ * for two more steps before it sleeps again
+ * @param components The components of the machine
+ */
+void ActivityTracker::Wake(const ComponentStore& components)
+{
+    auto& all = components.GetComponents();
+    for(auto component : all)
+    {
+        component->SetAsleep(false);
+    }
+
+    mResting.assign(all.size(), false);
+    mActiveCount = int(all.size());
+    mSleepingCount = 0;
+}
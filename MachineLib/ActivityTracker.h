@@ -0,0 +1,68 @@
+/**
+ * @file ActivityTracker.h
+ * @author Max Tetlow
+ *
+ * Keeps track of which components of a machine are asleep.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_ACTIVITYTRACKER_H
+#define CANADIANEXPERIENCE_MACHINELIB_ACTIVITYTRACKER_H
+
+#include <vector>
+
+class ComponentStore;
+
+/**
+ * Keeps track of which components of a machine are asleep.
+ *
+ * After every physics step each component is asked whether it is
+ * at rest: its bodies asleep in the physics system and nothing that
+ * drives it turning. A component at rest for two steps in a row is
+ * put to sleep. It has not moved since the step before, so it is
+ * drawn in the same place even between steps. Updates of sleeping
+ * components are skipped, and a sleeping component that was drawn
+ * asleep is not checked for changes when the frame is drawn.
+ *
+ * Anything that moves the machine outside of a physics step, like
+ * restoring a snapshot, must wake every component.
+ */
+class ActivityTracker
+{
+private:
+    /// Was each component at rest at the last check, in component order
+    std::vector<bool> mResting;
+
+    /// Number of components awake after the last check
+    int mActiveCount = 0;
+
+    /// Number of components asleep after the last check
+    int mSleepingCount = 0;
+
+public:
+    /// Constructor
+    ActivityTracker() = default;
+
+    /// Copy constructor (disabled)
+    ActivityTracker(const ActivityTracker &) = delete;
+
+    /// Assignment operator
+    void operator=(const ActivityTracker &) = delete;
+
+    void Update(const ComponentStore& components);
+
+    void Wake(const ComponentStore& components);
+
+    /**
+     * Get the number of components that are awake
+     * @return Number of active components
+     */
+    int GetActiveCount() const {return mActiveCount;}
+
+    /**
+     * Get the number of components that are asleep
+     * @return Number of sleeping components
+     */
+    int GetSleepingCount() const {return mSleepingCount;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_ACTIVITYTRACKER_H
@@ -6,8 +6,13 @@
 #include "pch.h"
 #include "ActualMachineSystem.h"
 #include "Machine.h"
-#include "Machine1Factory.h"
-#include "Machine2Factory.h"
+#include "MachineFactory.h"
+#include "MachineSnapshot.h"
+#include "Trace.h"
+
+/// The machine numbers MachineFactory can build.
+/// All of them are built in the background so switching is instantaneous.
+const int MachineNumbers[] = {1, 2};
 
 /**
  * constructor for the machine system
@@ -15,7 +20,20 @@
  */
 ActualMachineSystem::ActualMachineSystem(std::wstring resourcesDir):mResourcesDir(resourcesDir)
 {
-    SetMachineNumber(1);
+    // Images are packed once, here on the main thread, so the
+    // machines built on worker threads only look them up
+    MachineFactory factory(mResourcesDir);
+    factory.LoadImages();
+
+    // We need something to draw right away, so the
+    // first machine is built on this thread
+    mMachine = factory.Create(mMachineNumber);
+    mMachine->SetSystem(this);
+
+    for(auto number : MachineNumbers)
+    {
+        Build(number);
+    }
 }
 
 /**
@@ -42,11 +60,25 @@ wxPoint ActualMachineSystem::GetLocation()
 */
 void ActualMachineSystem::DrawMachine(std::shared_ptr<wxGraphicsContext> graphics)
 {
+    SwapMachine();
+
+    auto start = Trace::Now();
+
     graphics->PushState();
     graphics->Translate(mLocation.x, mLocation.y);
     graphics->Scale(mPixelsPerCentimeter, -mPixelsPerCentimeter);
     mMachine->Draw(graphics);
+    if(mFlags & PhysicsFlag)
+    {
+        mMachine->DrawPhysics(graphics);
+    }
     graphics->PopState();
+
+    if(mFlags & PerformanceFlag)
+    {
+        mHud.AddDrawTime(Trace::Now() - start);
+        mHud.Draw(graphics, mMachine.get());
+    }
 }
 
 /**
@@ -55,18 +87,43 @@ void ActualMachineSystem::DrawMachine(std::shared_ptr<wxGraphicsContext> graphic
 */
 void ActualMachineSystem::SetMachineFrame(int frame)
 {
+    MACHINE_TRACE("Frame", "ActualMachineSystem::SetMachineFrame");
+
+    auto start = Trace::Now();
+    SwapMachine();
+
     if(frame < mFrame)
     {
-        mFrame = 0;
-        mMachine->Reset();
+        // Start from the nearest keyframe at or before
+        // the frame rather than all the way back at zero
+        auto keyframe = mKeyframes.Find(frame);
+        if(keyframe != nullptr && keyframe->Restore(mMachine.get()))
+        {
+            mFrame = keyframe->GetFrame();
+        }
+        else
+        {
+            mFrame = 0;
+            mMachine->Reset();
+        }
     }
 
-    for( ; mFrame < frame;  mFrame++)
+    while(mFrame < frame)
     {
+        mMachine->Advance(1.0 / mFrameRate);
+        mFrame++;
 
-        mMachine->Update(1.0 / mFrameRate);
+        if(mKeyframes.IsKeyframe(mFrame))
+        {
+            mKeyframes.Add(std::make_shared<MachineSnapshot>(mMachine.get(), mFrame));
+        }
     }
     SetMachineTime(mFrame/mFrameRate);
+
+    if(mFlags & PerformanceFlag)
+    {
+        mHud.AddUpdateTime(Trace::Now() - start);
+    }
 }
 
 /**
@@ -75,31 +132,141 @@ void ActualMachineSystem::SetMachineFrame(int frame)
  */
 void ActualMachineSystem::SetFrameRate(double rate)
 {
+    if(rate != mFrameRate)
+    {
+        // Keyframes were taken at the old time step
+        mKeyframes.Clear();
+    }
+
     mFrameRate = rate;
 }
 
 /**
 * Set the machine number
+*
+* Numbers MachineFactory cannot build are ignored
+* and the current machine keeps running.
 * @param machine An integer number. Each number makes a different machine
 */
 void ActualMachineSystem::SetMachineNumber(int machine)
 {
-    if(machine == 1)
+    MachineFactory factory(mResourcesDir);
+    if(!factory.IsAvailable(machine))
+    {
+        return;
+    }
+
+    mMachineNumber = machine;
+
+    if(mMachine->GetNumber() == machine)
     {
-        Machine1Factory machine1Factory(mResourcesDir);
-        mMachine = machine1Factory.Create();
-        mMachine->SetMachineNumber(1);
-        mMachine->SetSystem(this);
+        // Already running this machine, start it over
+        mKeyframes.Clear();
+        mFrame = 0;
         mMachine->Reset();
+        SetMachineTime(0);
+        return;
+    }
+
+    // The old machine keeps drawing until the new one is built
+    Build(machine);
+    SwapMachine();
+}
+
+/**
+ * Start building a machine on a worker thread.
+ *
+ * Does nothing if the machine is already built or being built.
+ * @param machine Machine number
+ */
+void ActualMachineSystem::Build(int machine)
+{
+    if(mMachine->GetNumber() == machine ||
+        mReady.find(machine) != mReady.end() ||
+        mBuilding.find(machine) != mBuilding.end())
+    {
+        return;
+    }
+
+    // The factory decodes the images, builds the geometry
+    // and creates the physics world for the machine. No wx
+    // objects are created, those wait for SwapMachine.
+    auto resourcesDir = mResourcesDir;
+    mBuilding[machine] = std::async(std::launch::async, [resourcesDir, machine]() {
+        MachineFactory factory(resourcesDir);
+        return factory.Create(machine);
+    });
+}
+
+/**
+ * Swap in the machine last asked for if it is ready.
+ *
+ * The machine that was running is kept so switching
+ * back to it is instantaneous.
+ * @return true if the machine was swapped
+ */
+bool ActualMachineSystem::SwapMachine()
+{
+    if(mMachine->GetNumber() == mMachineNumber)
+    {
+        return false;
+    }
+
+    std::shared_ptr<Machine> machine;
+
+    auto ready = mReady.find(mMachineNumber);
+    if(ready != mReady.end())
+    {
+        machine = ready->second;
+        mReady.erase(ready);
+        machine->Reset();
     }
     else
     {
-        Machine2Factory machine2Factory(mResourcesDir);
-        mMachine = machine2Factory.Create();
-        mMachine->SetMachineNumber(2);
-        mMachine->SetSystem(this);
-        mMachine->Reset();
+        auto building = mBuilding.find(mMachineNumber);
+        if(building == mBuilding.end() ||
+            building->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return false;
+        }
+
+        machine = building->second.get();
+        mBuilding.erase(building);
+
+        if(machine == nullptr)
+        {
+            // The machine file could not be loaded, which the
+            // factory has reported, so keep the machine we have
+            mMachineNumber = mMachine->GetNumber();
+            return false;
+        }
+
+        // Built on a worker thread, which only made plain data
+        machine->CreateGraphics();
     }
+
+    mReady[mMachine->GetNumber()] = mMachine;
+
+    mMachine = machine;
+    mMachine->SetSystem(this);
+    mKeyframes.Clear();
+    mFrame = 0;
+    SetMachineTime(0);
+    return true;
+}
+
+/**
+ * Block until the machine last asked for is built and swapped in
+ */
+void ActualMachineSystem::WaitForMachine()
+{
+    auto building = mBuilding.find(mMachineNumber);
+    if(building != mBuilding.end())
+    {
+        building->second.wait();
+    }
+
+    SwapMachine();
 }
 
 /**
@@ -108,7 +275,7 @@ void ActualMachineSystem::SetMachineNumber(int machine)
  */
 int ActualMachineSystem::GetMachineNumber()
 {
-    return mMachine->GetNumber();
+    return mMachineNumber;
 }
 
 /**
@@ -130,11 +297,20 @@ double ActualMachineSystem::GetMachineTime()
 }
 
 /**
- * function for setting flags in the machine system
- * @param flag
+ * Set the flags from the control panel.
+ *
+ * PerformanceFlag shows the performance overlay on top of the machine
+ * and PhysicsFlag draws the machine as the physics system sees it.
+ * @param flag Flags, 8 bits set from the control panel
  */
 void ActualMachineSystem::SetFlag(int flag)
 {
+    if((flag & PerformanceFlag) && !(mFlags & PerformanceFlag))
+    {
+        // Physics time is counted all along, start the graph from now
+        mMachine->TakePhysicsTime();
+    }
 
+    mFlags = flag;
 }
 
@@ -8,7 +8,12 @@
 #ifndef CANADIANEXPERIENCE_MACHINELIB_ACTUALMACHINESYSTEM_H
 #define CANADIANEXPERIENCE_MACHINELIB_ACTUALMACHINESYSTEM_H
 
+#include <future>
+#include <map>
+
 #include "IMachineSystem.h"
+#include "KeyframeCache.h"
+#include "PerformanceHud.h"
 
 class Machine;
 /**
@@ -31,15 +36,43 @@ private:
     std::wstring mResourcesDir;
 
     /// The current frame we are on in the machine system
-    int mFrame;
+    int mFrame = 0;
 
     ///The frame rate
-    double mFrameRate;
+    double mFrameRate = 30;
 
     /// The current time in the machine system
-    double mTime;
+    double mTime = 0;
+
+    /// Periodic snapshots of the machine used when seeking backwards
+    KeyframeCache mKeyframes;
+
+    /// The machine number last asked for. The machine being
+    /// drawn may still be the old one until this one is built.
+    int mMachineNumber = 1;
+
+    /// Machines being built on a worker thread, indexed by machine number
+    std::map<int, std::future<std::shared_ptr<Machine>>> mBuilding;
+
+    /// Machines that are built and waiting to be used, indexed by machine number
+    std::map<int, std::shared_ptr<Machine>> mReady;
+
+    /// The flags last set from the control panel
+    int mFlags = 0;
+
+    /// Overlay showing where the time of each frame goes
+    PerformanceHud mHud;
+
+    void Build(int machine);
+
+    bool SwapMachine();
 
 public:
+    /// SetFlag bit that shows the performance overlay
+    static const int PerformanceFlag = 0x01;
+
+    /// SetFlag bit that draws the physics system on top of the machine
+    static const int PhysicsFlag = 0x02;
 
     /// Constructor
     ActualMachineSystem(std::wstring resourcesDir);
@@ -70,6 +103,20 @@ public:
 
     virtual void SetFlag(int flag) override;
 
+    void WaitForMachine();
+
+    /**
+     * Set the number of frames between keyframe snapshots
+     * @param interval Interval in frames
+     */
+    void SetKeyframeInterval(int interval) {mKeyframes.SetInterval(interval);}
+
+    /**
+     * Set the maximum memory keyframe snapshots may use
+     * @param budget Budget in bytes
+     */
+    void SetKeyframeMemoryBudget(size_t budget) {mKeyframes.SetMemoryBudget(budget);}
+
     //void SetMachine(std::shared_ptr<Machine> machine);
 
 };
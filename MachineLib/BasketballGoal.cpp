@@ -79,6 +79,27 @@ void BasketballGoal::Draw(std::shared_ptr<wxGraphicsContext> graphics)
     mScoreboard.Draw(graphics);
 }
 
+/**
+ * function that gets the rectangle the goal and scoreboard draw in
+ * @return the bounds in cm
+ */
+wxRect2DDouble BasketballGoal::GetBounds()
+{
+    auto bounds = mPolygon.GetBounds(mLocation.x, mLocation.y, 0);
+    bounds.Union(mScoreboard.GetBounds());
+    return bounds;
+}
+
+/**
+ * Create the wx objects the goal draws with
+ */
+void BasketballGoal::CreateGraphics()
+{
+    mPolygon.CreateGraphics();
+    mPost.CreateGraphics();
+    mGoal.CreateGraphics();
+}
+
 /**
  * Handle a contact beginning
  * @param contact Contact object
@@ -133,3 +154,21 @@ void BasketballGoal::StartScoreboard()
     mScoreboard.SetScore(0);
     mScoreboard.SetGoal(this);
 }
+
+/**
+ * Save the score on the scoreboard
+ * @param state Vector to append the state values to
+ */
+void BasketballGoal::SaveState(std::vector<double>& state)
+{
+    state.push_back(mScoreboard.GetScore());
+}
+
+/**
+ * Restore the state saved by SaveState
+ * @param state Iterator to read the state values from
+ */
+void BasketballGoal::RestoreState(std::vector<double>::const_iterator& state)
+{
+    mScoreboard.SetScore(int(*state++));
+}
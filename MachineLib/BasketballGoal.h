@@ -18,7 +18,7 @@
 /**
  * the class the represent the basketball goal
  */
-class BasketballGoal :  public Component, public b2ContactListener
+class BasketballGoal final : public Component, public b2ContactListener
 {
 private:
 
@@ -55,7 +55,29 @@ public:
     void PreSolve(b2Contact *contact, const b2Manifold *oldManifold) override;
     void SetPhysic(std::shared_ptr<ContactListener> listen, std::shared_ptr<b2World> world) override;
     void StartScoreboard();
+
+    /**
+     * Get the score on the scoreboard
+     * @return the score
+     */
+    int GetScore() {return mScoreboard.GetScore();}
+    void SaveState(std::vector<double>& state) override;
+    void RestoreState(std::vector<double>::const_iterator& state) override;
     cse335::PhysicsPolygon * GetPolygon() override;
+    wxRect2DDouble GetBounds() override;
+    void CreateGraphics() override;
+
+    /**
+     * Has the score changed since the goal was last drawn?
+     * @return true if the scoreboard needs drawing again
+     */
+    bool IsChanged() override {return mScoreboard.IsChanged();}
+
+    /**
+     * checks that nothing awake is touching the goal
+     * @return true if the goal is at rest
+     */
+    bool IsResting() override {return mPost.IsResting() && mGoal.IsResting();}
 
 };
 
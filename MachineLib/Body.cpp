@@ -40,5 +40,11 @@ void Body::SetPhysic(std::shared_ptr<ContactListener> listen, std::shared_ptr<b2
  */
 void Body::Rotate(double rotation, double speed)
 {
+    // A body asleep already has no angular velocity
+    if(speed == 0 && IsAsleep())
+    {
+        return;
+    }
+
     mPolygon.SetAngularVelocity(speed);
 }
\ No newline at end of file
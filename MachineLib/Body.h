@@ -17,7 +17,7 @@ class RotationSource;
 /**
  * class that represents non specified objects in the machine
  */
-class Body : public Component, public RotationSink
+class Body final : public Component, public RotationSink
 {
 private:
 
@@ -49,6 +49,32 @@ public:
      */
     void SetSource(RotationSource* source) override {mSink = source;};
 
+    /**
+     * A body is static if the physics never moves it
+     * and no rotation source drives it
+     * @return true if the body always looks the same
+     */
+    bool IsStatic() override {return mSink == nullptr && mPolygon.GetType() == b2_staticBody;}
+
+    /**
+     * Get the rectangle the body draws in
+     * @return Bounds in centimeters
+     */
+    wxRect2DDouble GetBounds() override {return mPolygon.GetBounds();}
+
+    /**
+     * Has the body moved since it was last drawn?
+     * @return true if the body has moved
+     */
+    bool IsChanged() override {return mPolygon.HasMoved();}
+
+    /**
+     * Is the body asleep in the physics system,
+     * along with everything touching it?
+     * @return true if the body is at rest
+     */
+    bool IsResting() override {return mPolygon.IsResting();}
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_BODY_H
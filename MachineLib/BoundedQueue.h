@@ -0,0 +1,114 @@
+/**
+ * @file BoundedQueue.h
+ * @author Max Tetlow
+ *
+ * Queue between two threads that holds a limited number of items.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_BOUNDEDQUEUE_H
+#define CANADIANEXPERIENCE_MACHINELIB_BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/**
+ * Queue between two threads that holds a limited number of items.
+ *
+ * Push waits while the queue is full, so a producer that is faster
+ * than its consumer is held back instead of using more memory. Once
+ * the queue is closed Push drops its item and Pop returns what is
+ * left, then fails, which ends both ends of a pipeline stage.
+ * @tparam T Type of the items
+ */
+template <class T>
+class BoundedQueue
+{
+private:
+    /// Items waiting to be taken
+    std::deque<T> mItems;
+
+    /// Maximum number of items waiting
+    size_t mCapacity;
+
+    /// Set when no more items will be pushed
+    bool mClosed = false;
+
+    /// Protects the queue state
+    std::mutex mMutex;
+
+    /// Wakes a thread waiting to pop
+    std::condition_variable mNotEmpty;
+
+    /// Wakes a thread waiting to push
+    std::condition_variable mNotFull;
+
+public:
+    /**
+     * Constructor
+     * @param capacity Maximum number of items waiting
+     */
+    explicit BoundedQueue(size_t capacity) : mCapacity(capacity > 0 ? capacity : 1) {}
+
+    /// Default constructor (disabled)
+    BoundedQueue() = delete;
+
+    /// Copy constructor (disabled)
+    BoundedQueue(const BoundedQueue &) = delete;
+
+    /// Assignment operator
+    void operator=(const BoundedQueue &) = delete;
+
+    /**
+     * Add an item, waiting until there is room for it
+     * @param item Item to add
+     * @return true if added, false if the queue has been closed
+     */
+    bool Push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mNotFull.wait(lock, [this]() {return mClosed || mItems.size() < mCapacity;});
+        if(mClosed)
+        {
+            return false;
+        }
+
+        mItems.push_back(std::move(item));
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * Take the oldest item, waiting until there is one
+     * @param item Set to the item taken
+     * @return true if an item was taken, false if the queue
+     * is closed and empty
+     */
+    bool Pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mNotEmpty.wait(lock, [this]() {return mClosed || !mItems.empty();});
+        if(mItems.empty())
+        {
+            return false;
+        }
+
+        item = std::move(mItems.front());
+        mItems.pop_front();
+        mNotFull.notify_one();
+        return true;
+    }
+
+    /**
+     * Close the queue, no more items can be pushed
+     */
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+        mNotEmpty.notify_all();
+        mNotFull.notify_all();
+    }
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_BOUNDEDQUEUE_H
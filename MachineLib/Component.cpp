@@ -33,6 +33,21 @@ void Component::Update(double elapsed)
 
 }
 
+/**
+ * Create the wx objects the component draws with. Components
+ * are built without them so they can be built on any thread.
+ * Components with more than one polygon override this.
+ * @see cse335::Polygon::CreateGraphics
+ */
+void Component::CreateGraphics()
+{
+    auto polygon = GetPolygon();
+    if(polygon != nullptr)
+    {
+        polygon->CreateGraphics();
+    }
+}
+
 /**
  * used to set the machine this component belongs to
  * @param machine
@@ -23,6 +23,9 @@ private:
     ///the machine this component belongs to
     Machine* mMachine = nullptr;
 
+    /// Has the component been at rest for the last two steps?
+    bool mAsleep = false;
+
 public:
 
     Component();
@@ -37,6 +40,8 @@ public:
      */
     virtual cse335::Polygon* GetPolygon() {return nullptr;}
 
+    virtual void CreateGraphics();
+
     /**
      * virtual function to set physics, only used in override
      * @param listen contact listener in physics world
@@ -50,6 +55,63 @@ public:
      */
     virtual void SetRotation(double r){}
 
+    /**
+     * Does this component always look the same? Static
+     * components are drawn once into a cached layer.
+     * @return false unless overridden
+     */
+    virtual bool IsStatic() {return false;}
+
+    /**
+     * Get the rectangle this component draws in, so only
+     * the parts of the machine that change are drawn again.
+     * @return Bounds in centimeters, empty if not known
+     */
+    virtual wxRect2DDouble GetBounds() {return wxRect2DDouble();}
+
+    /**
+     * Has what this component draws changed since it was last drawn?
+     * @return true unless overridden
+     */
+    virtual bool IsChanged() {return true;}
+
+    /**
+     * Is the component at rest? A component is at rest when nothing
+     * about it changed in the last physics step and nothing will
+     * change it until something else wakes it. Called once after
+     * every physics step by the ActivityTracker.
+     * @return false unless overridden
+     */
+    virtual bool IsResting() {return false;}
+
+    /**
+     * Is the component asleep? A component is asleep once it has
+     * been at rest for two steps in a row, so it no longer moves
+     * even between physics steps and its updates can be skipped.
+     * @return true if the component is asleep
+     */
+    bool IsAsleep() {return mAsleep;}
+
+    /**
+     * Set whether the component is asleep
+     * @param asleep true if the component is asleep
+     */
+    void SetAsleep(bool asleep) {mAsleep = asleep;}
+
+    /**
+     * Save the state this component keeps outside of the
+     * physics system, only used in override
+     * @param state Vector to append the state values to
+     */
+    virtual void SaveState(std::vector<double>& state) {}
+
+    /**
+     * Restore state saved by SaveState, only used in override
+     * @param state Iterator to read the state values from,
+     * advanced past the values this component saved
+     */
+    virtual void RestoreState(std::vector<double>::const_iterator& state) {}
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_COMPONENT_H
@@ -0,0 +1,93 @@
+/**
+ * @file ComponentStore.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "ComponentStore.h"
+#include "Body.h"
+#include "Hamster.h"
+#include "Conveyor.h"
+#include "Pulley.h"
+#include "BasketballGoal.h"
+#include "Trace.h"
+
+/**
+ * Constructor
+ */
+ComponentStore::ComponentStore()
+{
+}
+
+/**
+ * Add a component to the store.
+ *
+ * The component type is found once here, so no
+ * pass over the components ever has to look it up.
+ * @param component Component to add
+ */
+void ComponentStore::Add(std::shared_ptr<Component> component)
+{
+    auto raw = component.get();
+    mOwned.push_back(std::move(component));
+    mComponents.push_back(raw);
+
+    if(auto body = dynamic_cast<Body*>(raw))
+    {
+        mBodies.push_back(body);
+    }
+    else if(auto hamster = dynamic_cast<Hamster*>(raw))
+    {
+        mHamsters.push_back(hamster);
+    }
+    else if(auto conveyor = dynamic_cast<Conveyor*>(raw))
+    {
+        mConveyors.push_back(conveyor);
+    }
+    else if(auto pulley = dynamic_cast<Pulley*>(raw))
+    {
+        mPulleys.push_back(pulley);
+    }
+    else if(auto goal = dynamic_cast<BasketballGoal*>(raw))
+    {
+        mGoals.push_back(goal);
+    }
+    else
+    {
+        mOthers.push_back(raw);
+    }
+}
+
+/**
+ * Advance every component in time.
+ *
+ * Hamsters are the only known component type with an update,
+ * so the other typed arrays are not visited at all. Components
+ * the ActivityTracker has found asleep are skipped.
+ * @param elapsed Time to advance in seconds
+ */
+void ComponentStore::Update(double elapsed)
+{
+    for(auto hamster : mHamsters)
+    {
+        // A hamster asleep is not running and updating it changes nothing
+        if(hamster->IsAsleep())
+        {
+            continue;
+        }
+
+        MACHINE_TRACE("Update", "Hamster");
+        hamster->Update(elapsed);
+    }
+
+    for(auto component : mOthers)
+    {
+        if(component->IsAsleep())
+        {
+            continue;
+        }
+
+        MACHINE_TRACE_TYPE("Update", *component);
+        component->Update(elapsed);
+    }
+}
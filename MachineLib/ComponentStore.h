@@ -0,0 +1,118 @@
+/**
+ * @file ComponentStore.h
+ * @author Max Tetlow
+ *
+ * The components of a machine, grouped by type.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_COMPONENTSTORE_H
+#define CANADIANEXPERIENCE_MACHINELIB_COMPONENTSTORE_H
+
+#include <memory>
+#include <vector>
+
+class Component;
+class Body;
+class Hamster;
+class Conveyor;
+class Pulley;
+class BasketballGoal;
+
+/**
+ * The components of a machine, grouped by type.
+ *
+ * The store owns the components through the shared pointers the
+ * factories create them with. Every pass over the components uses
+ * plain pointer arrays instead, so there is no reference counting
+ * per component per frame. Each concrete type has its own array,
+ * so a pass that only concerns one type (only hamsters have an
+ * update, for example) walks just that array and calls the
+ * component without virtual dispatch.
+ *
+ * Passes where order matters, drawing and installing the physics,
+ * use the order the components were added in.
+ */
+class ComponentStore
+{
+private:
+    /// Owns the components, in the order they were added
+    std::vector<std::shared_ptr<Component>> mOwned;
+
+    /// Every component in the order it was added
+    std::vector<Component*> mComponents;
+
+    /// The bodies
+    std::vector<Body*> mBodies;
+
+    /// The hamsters
+    std::vector<Hamster*> mHamsters;
+
+    /// The conveyors
+    std::vector<Conveyor*> mConveyors;
+
+    /// The pulleys
+    std::vector<Pulley*> mPulleys;
+
+    /// The basketball goals
+    std::vector<BasketballGoal*> mGoals;
+
+    /// Components of any other type, updated through Component
+    std::vector<Component*> mOthers;
+
+public:
+    ComponentStore();
+
+    /// Copy constructor (disabled)
+    ComponentStore(const ComponentStore &) = delete;
+
+    /// Assignment operator
+    void operator=(const ComponentStore &) = delete;
+
+    void Add(std::shared_ptr<Component> component);
+
+    void Update(double elapsed);
+
+    /**
+     * Get every component in the order they were added
+     * @return Vector of components
+     */
+    const std::vector<Component*>& GetComponents() const {return mComponents;}
+
+    /**
+     * Get the bodies in the order they were added
+     * @return Vector of bodies
+     */
+    const std::vector<Body*>& GetBodies() const {return mBodies;}
+
+    /**
+     * Get the hamsters in the order they were added
+     * @return Vector of hamsters
+     */
+    const std::vector<Hamster*>& GetHamsters() const {return mHamsters;}
+
+    /**
+     * Get the conveyors in the order they were added
+     * @return Vector of conveyors
+     */
+    const std::vector<Conveyor*>& GetConveyors() const {return mConveyors;}
+
+    /**
+     * Get the pulleys in the order they were added
+     * @return Vector of pulleys
+     */
+    const std::vector<Pulley*>& GetPulleys() const {return mPulleys;}
+
+    /**
+     * Get the basketball goals in the order they were added
+     * @return Vector of goals
+     */
+    const std::vector<BasketballGoal*>& GetGoals() const {return mGoals;}
+
+    /**
+     * Get the number of components
+     * @return Number of components
+     */
+    size_t GetCount() const {return mComponents.size();}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_COMPONENTSTORE_H
@@ -4,7 +4,7 @@
  */
 
 #include "pch.h"
-#include <b2_contact.h>
+#include <algorithm>
 
 #include "ContactListener.h"
 
@@ -14,6 +14,16 @@
  */
 void ContactListener::BeginContact(b2Contact *contact)
 {
+    if(!mSuppressed.empty())
+    {
+        b2Body* bodyA = contact->GetFixtureA()->GetBody();
+        b2Body* bodyB = contact->GetFixtureB()->GetBody();
+        if(mSuppressed.erase(std::minmax(bodyA, bodyB)) > 0)
+        {
+            return;
+        }
+    }
+
     b2ContactListener* listener = nullptr;
     if(ShouldDispatch(contact, 1, listener))
     {
@@ -26,6 +36,62 @@ void ContactListener::BeginContact(b2Contact *contact)
     }
 }
 
+/**
+ * Suppress the next BeginContact between two bodies.
+ *
+ * Used when a snapshot is restored with the bodies already
+ * touching, so the contact is not handled a second time. The
+ * physics system does not update contacts between sleeping
+ * bodies, so that BeginContact may come many steps later.
+ * @param bodyA First body
+ * @param bodyB Second body
+ */
+void ContactListener::Suppress(b2Body *bodyA, b2Body *bodyB)
+{
+    mSuppressed.insert(std::minmax(bodyA, bodyB));
+}
+
+/**
+ * Start the solver for a contact between two bodies from
+ * the impulses in a manifold the next time they touch.
+ *
+ * Used when a snapshot is restored, so resting contacts
+ * pick up where they were instead of starting from zero.
+ * @param bodyA Body of fixture A
+ * @param bodyB Body of fixture B
+ * @param manifold Manifold with the contact points and impulses
+ */
+void ContactListener::WarmStart(b2Body *bodyA, b2Body *bodyB, const b2Manifold &manifold)
+{
+    mWarmStarts[std::make_pair(bodyA, bodyB)] = manifold;
+}
+
+/**
+ * Handle the end of a contact situation
+ * @param contact Contact object
+ */
+void ContactListener::EndContact(b2Contact *contact)
+{
+    // A suppressed pair that ends without beginning again
+    // must begin normally the next time it touches
+    if(!mSuppressed.empty())
+    {
+        mSuppressed.erase(std::minmax(contact->GetFixtureA()->GetBody(),
+                                      contact->GetFixtureB()->GetBody()));
+    }
+
+    b2ContactListener* listener = nullptr;
+    if(ShouldDispatch(contact, 1, listener))
+    {
+        listener->EndContact(contact);
+    }
+
+    if(ShouldDispatch(contact, 2, listener))
+    {
+        listener->EndContact(contact);
+    }
+}
+
 /**
  * This function is called before the contact occurs
  * @param contact Contact object
@@ -33,6 +99,33 @@ void ContactListener::BeginContact(b2Contact *contact)
  */
 void ContactListener::PreSolve(b2Contact *contact, const b2Manifold *oldManifold)
 {
+    if(!mWarmStarts.empty())
+    {
+        auto saved = mWarmStarts.find(std::make_pair(contact->GetFixtureA()->GetBody(),
+                                                     contact->GetFixtureB()->GetBody()));
+        if(saved != mWarmStarts.end())
+        {
+            // Points are matched by their feature ids, the same
+            // way the physics system matches them between steps
+            auto manifold = contact->GetManifold();
+            for(int i=0; i<manifold->pointCount; i++)
+            {
+                auto& point = manifold->points[i];
+                for(int j=0; j<saved->second.pointCount; j++)
+                {
+                    auto& savedPoint = saved->second.points[j];
+                    if(savedPoint.id.key == point.id.key)
+                    {
+                        point.normalImpulse = savedPoint.normalImpulse;
+                        point.tangentImpulse = savedPoint.tangentImpulse;
+                    }
+                }
+            }
+
+            mWarmStarts.erase(saved);
+        }
+    }
+
     b2ContactListener* listener = nullptr;
     if(ShouldDispatch(contact, 1, listener))
     {
@@ -46,31 +139,20 @@ void ContactListener::PreSolve(b2Contact *contact, const b2Manifold *oldManifold
 }
 
 /**
- * Should a contact be dispatched to an installed listener for some body?
- *
- * We have installed listeners in mDispatch for bodies. This tests to see
- * if either of the two bodies involved  in the collision are in the
- * mDispatch map. If so, the listener reference value is set and a
- * true value is returned.
- *
- * @param contact Contact to test
- * @param body Which body for the contact (1 or 2?)
- * @param listener Where to put the listener to call the function on
- * @return true if we should dispatch this contact
+ * Called after the solve has been computed, but before the contact is reported
+ * @param contact Contact object
+ * @param impulse Impulse related to the contact
  */
- bool ContactListener::ShouldDispatch(b2Contact *contact, int body, b2ContactListener* &listener)
+void ContactListener::PostSolve(b2Contact *contact, const b2ContactImpulse *impulse)
 {
-    b2Body* bodyD = body == 1 ? contact->GetFixtureA()->GetBody() :
-                               contact->GetFixtureB()->GetBody();
-
-    auto dispatchA = mDispatch.find(bodyD);
-    if(dispatchA != mDispatch.end())
+    b2ContactListener* listener = nullptr;
+    if(ShouldDispatch(contact, 1, listener))
     {
-       listener = dispatchA->second;
-       return true;
+        listener->PostSolve(contact, impulse);
     }
 
-    return false;
+    if(ShouldDispatch(contact, 2, listener))
+    {
+        listener->PostSolve(contact, impulse);
+    }
 }
-
-
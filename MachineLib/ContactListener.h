@@ -10,7 +10,11 @@
 #define CANADIANEXPERIENCE_MACHINELIB_CONTACTLISTENER_H
 
 #include <map>
+#include <set>
 #include <b2_world_callbacks.h>
+#include <b2_body.h>
+#include <b2_contact.h>
+#include <b2_fixture.h>
 
 /**
  * A contact filter allows for testing for things
@@ -20,39 +24,79 @@ class ContactListener : public b2ContactListener
 {
 private:
     /**
-     * Keep track of bodies we want to dispatch
-     * the contact listener to.
+     * Pairs of bodies that are already touching when a
+     * snapshot is restored. The next BeginContact for these
+     * is not dispatched again. A pair stays here until it
+     * begins or ends, which can be many steps after the
+     * restore when one of the bodies is asleep.
      */
-    std::map<b2Body*, b2ContactListener*> mDispatch;
+    std::set<std::pair<b2Body*, b2Body*>> mSuppressed;
 
-    bool ShouldDispatch(b2Contact *contact, int body, b2ContactListener* &listener);
+    /**
+     * Contact points of bodies that were touching when a
+     * snapshot was restored, keyed by the bodies of fixtures
+     * A and B. The impulses in them are what the solver
+     * starts from on the next step.
+     */
+    std::map<std::pair<b2Body*, b2Body*>, b2Manifold> mWarmStarts;
+
+    /**
+     * Should a contact be dispatched to an installed listener for some body?
+     *
+     * The listener for a body is kept in the body user data, so
+     * this is a pointer load. Contacts between bodies with no
+     * listener, like domino on domino, cost almost nothing.
+     *
+     * @param contact Contact to test
+     * @param body Which body for the contact (1 or 2?)
+     * @param listener Where to put the listener to call the function on
+     * @return true if we should dispatch this contact
+     */
+    static bool ShouldDispatch(b2Contact *contact, int body, b2ContactListener* &listener)
+    {
+        b2Body* bodyD = body == 1 ? contact->GetFixtureA()->GetBody() :
+                                    contact->GetFixtureB()->GetBody();
+
+        listener = reinterpret_cast<b2ContactListener*>(bodyD->GetUserData().pointer);
+        return listener != nullptr;
+    }
 
 public:
     /**
      * Add a dispatched listener for some body.
+     *
+     * The listener is stored in the body user data.
      * @param body Body to listen for
      * @param listener Listener to call
      */
-    void Add(b2Body* body, b2ContactListener* listener) {mDispatch[body] = listener;}
+    void Add(b2Body* body, b2ContactListener* listener)
+    {
+        body->GetUserData().pointer = reinterpret_cast<uintptr_t>(listener);
+    }
 
-    void BeginContact(b2Contact* contact) override;
+    void Suppress(b2Body* bodyA, b2Body* bodyB);
+
+    void WarmStart(b2Body* bodyA, b2Body* bodyB, const b2Manifold& manifold);
 
     /**
-     * Handle the end of a contact situation
-     * @param contact Contact object
+     * Stop suppressing BeginContact and warm starting for
+     * every pair. Called when another snapshot is restored.
      */
-    void EndContact(b2Contact* contact) override
-    { /* handle end event */ }
-
-    void PreSolve(b2Contact* contact, const b2Manifold* oldManifold) override;
+    void ClearSuppressed() {mSuppressed.clear(); mWarmStarts.clear();}
 
     /**
-     * Called after the solve has been computed, but before the contact is reported
-     * @param contact Contact object
-     * @param impulse Impulse related to the contact
+     * Get the pairs of bodies whose next BeginContact is suppressed
+     * @return Pairs of bodies, lower pointer first
      */
-    void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override
-    { /* handle post-solve event */ }
+    const std::set<std::pair<b2Body*, b2Body*>>& GetSuppressed() const {return mSuppressed;}
+
+    void BeginContact(b2Contact* contact) override;
+
+    void EndContact(b2Contact* contact) override;
+
+    void PreSolve(b2Contact* contact, const b2Manifold* oldManifold) override;
+
+    void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override;
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_CONTACTLISTENER_H
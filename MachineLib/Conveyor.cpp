@@ -90,6 +90,13 @@ void Conveyor::Rotate(double rotation, double speed)
     {
         mSpeed = speed;
     }
+
+    // Everything on a stopped belt that is asleep already stands still
+    if(mSpeed == 0 && IsAsleep())
+    {
+        return;
+    }
+
     auto contact = mConveyor.GetBody()->GetContactList();
     while(contact != nullptr)
     {
@@ -100,4 +107,22 @@ void Conveyor::Rotate(double rotation, double speed)
 
         contact = contact->next;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Save the conveyor belt speed
+ * @param state Vector to append the state values to
+ */
+void Conveyor::SaveState(std::vector<double>& state)
+{
+    state.push_back(mSpeed);
+}
+
+/**
+ * Restore the state saved by SaveState
+ * @param state Iterator to read the state values from
+ */
+void Conveyor::RestoreState(std::vector<double>::const_iterator& state)
+{
+    mSpeed = *state++;
+}
@@ -16,7 +16,7 @@ class RotationSource;
 /**
  * class the represents a conveyor object in the machine
  */
-class Conveyor : public Component , public RotationSink , public b2ContactListener
+class Conveyor final : public Component , public RotationSink , public b2ContactListener
 {
 private:
 
@@ -40,6 +40,8 @@ public:
     void Rotate(double rotation, double speed) override;
     void SetPhysic(std::shared_ptr<ContactListener> listen, std::shared_ptr<b2World> world) override;
     void PreSolve(b2Contact *contact, const b2Manifold *oldManifold) override;
+    void SaveState(std::vector<double>& state) override;
+    void RestoreState(std::vector<double>::const_iterator& state) override;
 
     /**
      * getter for the polygon that represents the conveyor
@@ -62,6 +64,30 @@ public:
      */
     void SetSource(RotationSource* source) override {mSink = source;}
 
+    /**
+     * The conveyor frame never moves, only the objects on it do
+     * @return true if the conveyor body is static
+     */
+    bool IsStatic() override {return mConveyor.GetType() == b2_staticBody;}
+
+    /**
+     * Get the rectangle the conveyor draws in
+     * @return Bounds in centimeters
+     */
+    wxRect2DDouble GetBounds() override {return mConveyor.GetBounds();}
+
+    /**
+     * Has the conveyor moved since it was last drawn?
+     * @return true if the conveyor has moved
+     */
+    bool IsChanged() override {return mConveyor.HasMoved();}
+
+    /**
+     * Is the belt stopped with nothing awake on it?
+     * @return true if the conveyor is at rest
+     */
+    bool IsResting() override {return mSpeed == 0 && mConveyor.IsResting();}
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_CONVEYOR_H
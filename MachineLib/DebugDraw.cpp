@@ -7,6 +7,11 @@
 #include "DebugDraw.h"
 #include "Consts.h"
 
+/// Color of the axes of a transform other than the x axis
+const b2Color TransformColor(1, 0, 0);
+
+/// Color of the x axis of a transform
+const b2Color TransformXColor(0, 1, 0);
 
 /**
  * Constructor
@@ -17,6 +22,25 @@ DebugDraw::DebugDraw(std::shared_ptr<wxGraphicsContext> graphics)
     mGraphics = graphics;
 }
 
+/**
+ * Get the path everything of a color is added to
+ * @param color Color to draw
+ * @return Path for the color
+ */
+wxGraphicsPath& DebugDraw::GetPath(const b2Color& color)
+{
+    uint32_t key = uint32_t(color.r * 255) << 24 | uint32_t(color.g * 255) << 16 |
+                   uint32_t(color.b * 255) << 8 | uint32_t(color.a * 255);
+
+    auto& path = mPaths[key];
+    if(path.IsNull())
+    {
+        path = mGraphics->CreatePath();
+    }
+
+    return path;
+}
+
 
 /**
  * Draw a circle
@@ -29,19 +53,16 @@ DebugDraw::DebugDraw(std::shared_ptr<wxGraphicsContext> graphics)
  */
 void DebugDraw::DrawCircle (const b2Vec2 &center, float radius, const b2Color &color)
 {
-    SetPenColor(color);
-    mGraphics->SetBrush(wxNullBrush);
+    double x = center.x * Consts::MtoCM * mFineLine;
+    double y = center.y * Consts::MtoCM * mFineLine;
+    double r = radius * Consts::MtoCM * mFineLine;
 
-    double x = center.x * Consts::MtoCM;
-    double y = center.y * Consts::MtoCM;
-    double r = radius * Consts::MtoCM;
-
-    mGraphics->DrawEllipse(x-r, y-r, r*2, r*2);
+    GetPath(color).AddCircle(x, y, r);
 }
 
 
 /**
- * Draw a circle
+ * Draw a circle with a line from the center along its axis
  * @param center Center of the circle in meters
  * @param radius Radius in meters
  * @param axis Axis to indicate any rotation
@@ -50,6 +71,7 @@ void DebugDraw::DrawCircle (const b2Vec2 &center, float radius, const b2Color &c
 void DebugDraw::DrawSolidCircle (const b2Vec2 &center, float radius, const b2Vec2 &axis, const b2Color &color)
 {
     DrawCircle(center, radius, color);
+    DrawSegment(center, center + radius * axis, color);
 }
 
 /**
@@ -60,22 +82,13 @@ void DebugDraw::DrawSolidCircle (const b2Vec2 &center, float radius, const b2Vec
  */
 void DebugDraw::DrawPolygon(const b2Vec2 *vertices, int32 vertexCount, const b2Color &color)
 {
-    SetPenColor(color);
-
-    auto path = mGraphics->CreatePath();
+    auto& path = GetPath(color);
     path.MoveToPoint(vertices[0].x * Consts::MtoCM * mFineLine, vertices[0].y * Consts::MtoCM * mFineLine);
     for(int i=1; i<vertexCount; i++)
     {
         path.AddLineToPoint(vertices[i].x * Consts::MtoCM * mFineLine, vertices[i].y * Consts::MtoCM * mFineLine);
     }
     path.CloseSubpath();
-
-    mGraphics->PushState();
-    mGraphics->Scale(1.0/mFineLine, 1.0/mFineLine);
-    mGraphics->SetPen(*wxRED_PEN);
-    mGraphics->SetBrush(wxNullBrush);
-    mGraphics->StrokePath(path);
-    mGraphics->PopState();
 }
 
 /**
@@ -100,18 +113,16 @@ void DebugDraw::DrawSolidPolygon(const b2Vec2 *vertices, int32 vertexCount, cons
  */
 void DebugDraw::DrawPoint (const b2Vec2 &p, float size, const b2Color &color)
 {
-    SetPenColor(color);
-
     auto x = p.x * Consts::MtoCM * mFineLine;
     auto y = p.y * Consts::MtoCM * mFineLine;
 
     auto crosshairRange = mCrosshairSize / 2 * Consts::MtoCM * mFineLine;
 
-    mGraphics->PushState();
-    mGraphics->Scale(1.0/mFineLine, 1.0/mFineLine);
-    mGraphics->StrokeLine(x - crosshairRange, y, x + crosshairRange, y);
-    mGraphics->StrokeLine(x, y - crosshairRange, x, y + crosshairRange);
-    mGraphics->PopState();
+    auto& path = GetPath(color);
+    path.MoveToPoint(x - crosshairRange, y);
+    path.AddLineToPoint(x + crosshairRange, y);
+    path.MoveToPoint(x, y - crosshairRange);
+    path.AddLineToPoint(x, y + crosshairRange);
 }
 
 /**
@@ -131,31 +142,17 @@ void DebugDraw::DrawTransform(const b2Transform &xf)
     auto s = xf.q.s * crosshairRange;    // sin of angle
     auto c = xf.q.c * crosshairRange;    // cos of angle
 
-    mGraphics->PushState();
-    mGraphics->Scale(1.0/mFineLine, 1.0/mFineLine);
-
     // Draw all but the direction to the right
-    mGraphics->SetPen(*wxRED_PEN);
-    mGraphics->StrokeLine(x - c, y - s, x, y);
-    mGraphics->StrokeLine(x + s, y - c, x - s, y + c);
+    auto& path = GetPath(TransformColor);
+    path.MoveToPoint(x - c, y - s);
+    path.AddLineToPoint(x, y);
+    path.MoveToPoint(x + s, y - c);
+    path.AddLineToPoint(x - s, y + c);
 
     // Draw that last part to the right in a different color
-    mGraphics->SetPen(*wxGREEN_PEN);
-    mGraphics->StrokeLine(x, y, x + c, y + s);
-
-    mGraphics->PopState();
-}
-
-/**
- * Set a pen with a given box2d color
- * @param color Color to set
- * @param width Pen width in pixels
- */
-void DebugDraw::SetPenColor(const b2Color &color, int width)
-{
-    wxColour clr(int(color.r*255), int(color.g*255), int(color.b*255), int(color.a*255));
-    wxPen pen(clr, width);
-    mGraphics->SetPen(pen);
+    auto& right = GetPath(TransformXColor);
+    right.MoveToPoint(x, y);
+    right.AddLineToPoint(x + c, y + s);
 }
 
 /**
@@ -166,16 +163,28 @@ void DebugDraw::SetPenColor(const b2Color &color, int width)
  */
 void DebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color)
 {
-    SetPenColor(color);
+    auto& path = GetPath(color);
+    path.MoveToPoint(p1.x * Consts::MtoCM * mFineLine, p1.y * Consts::MtoCM * mFineLine);
+    path.AddLineToPoint(p2.x * Consts::MtoCM * mFineLine, p2.y * Consts::MtoCM * mFineLine);
+}
 
-    auto x1 = p1.x * Consts::MtoCM;
-    auto y1 = p1.y * Consts::MtoCM;
+/**
+ * Stroke everything drawn since the last Flush, one stroke per color
+ */
+void DebugDraw::Flush()
+{
+    mGraphics->PushState();
+    mGraphics->Scale(1.0/mFineLine, 1.0/mFineLine);
+    mGraphics->SetBrush(wxNullBrush);
 
-    auto x2 = p2.x * Consts::MtoCM;
-    auto y2 = p2.y * Consts::MtoCM;
+    for(auto& path : mPaths)
+    {
+        auto key = path.first;
+        wxColour color(key >> 24 & 0xff, key >> 16 & 0xff, key >> 8 & 0xff, key & 0xff);
+        mGraphics->SetPen(wxPen(color, 1));
+        mGraphics->StrokePath(path.second);
+    }
 
-    mGraphics->SetPen(*wxRED_PEN);
-    mGraphics->StrokeLine(x1, y1, x2, y2);
+    mGraphics->PopState();
+    mPaths.clear();
 }
-
-
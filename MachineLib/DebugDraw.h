@@ -5,23 +5,31 @@
  * Debugging support to draw the world from the viewpoint
  * of the physics system.
  *
- * @version 2.00 Updated to support finer lines
+ * @version 2.01 Batches a frame into one path per color
  */
 
 #ifndef _DEBUGDRAW_H
 #define _DEBUGDRAW_H
 
+#include <map>
 #include <b2_draw.h>
 
 /**
  * Debugging support to draw the world from the viewpoint of the physics system.
+ *
+ * Nothing is drawn as it is passed in. Every shape is added to one
+ * path per color and Flush strokes each path once, so a large world
+ * costs one stroke per color rather than one per shape.
  */
 class DebugDraw : public b2Draw {
 private:
     /// Graphics context to draw on
     std::shared_ptr<wxGraphicsContext> mGraphics;
 
-    void SetPenColor(const b2Color& color, int width=1);
+    /// Everything drawn since the last Flush, one path per color
+    std::map<uint32_t, wxGraphicsPath> mPaths;
+
+    wxGraphicsPath& GetPath(const b2Color& color);
 
     /// Size of a crosshair in meters
     double mCrosshairSize = 0.15;
@@ -57,6 +65,7 @@ public:
     void DrawTransform(const b2Transform &xf) override;
     void DrawPoint (const b2Vec2 &p, float size, const b2Color &color) override;
 
+    void Flush();
 };
 
 #endif //_DEBUGDRAW_H
@@ -0,0 +1,385 @@
+/**
+ * @file FrameCache.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "FrameCache.h"
+#include "Component.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/// Pixels added around the bounds of a component
+/// to cover antialiasing and the width of lines
+const int BoundsMargin = 2;
+
+/**
+ * Draw the machine, drawing again only what changed.
+ * @param graphics Graphics device to render onto
+ * @param staticComponents Components that always look the same
+ * @param dynamicComponents Components drawn on top of the static ones
+ */
+void FrameCache::Draw(std::shared_ptr<wxGraphicsContext> graphics, const std::vector<Component*>& staticComponents,
+                      const std::vector<Component*>& dynamicComponents)
+{
+    double transform[6];
+    graphics->GetTransform().Get(&transform[0], &transform[1], &transform[2],
+                                 &transform[3], &transform[4], &transform[5]);
+
+    wxDouble width, height;
+    graphics->GetSize(&width, &height);
+    wxSize size(int(width), int(height));
+
+    if(size.x <= 0 || size.y <= 0)
+    {
+        // Nothing to size the tiles to, draw directly
+        for (auto component : staticComponents)
+        {
+            component->Draw(graphics);
+        }
+
+        for (auto component : dynamicComponents)
+        {
+            component->Draw(graphics);
+        }
+        return;
+    }
+
+    if(!mValid || size != mSize || !std::equal(transform, transform + 6, mTransform) ||
+        mDrawnBounds.size() != dynamicComponents.size())
+    {
+        std::copy(transform, transform + 6, mTransform);
+        mSize = size;
+        Build(graphics, staticComponents, dynamicComponents);
+    }
+
+    for (auto& tile : mTiles)
+    {
+        tile.mChanged = false;
+    }
+
+    // Damage where the changed components were and where they are now
+    for (size_t i=0; i<dynamicComponents.size(); i++)
+    {
+        auto component = dynamicComponents[i];
+        auto& drawn = mDrawnBounds[i];
+
+        // Drawn asleep and still asleep, so it has not moved
+        if(!drawn.IsEmpty() && mDrawnAsleep[i] && component->IsAsleep())
+        {
+            continue;
+        }
+
+        if(drawn.IsEmpty() || component->IsChanged())
+        {
+            Damage(drawn);
+
+            auto bounds = component->GetBounds();
+            drawn = bounds.IsEmpty() ? wxRect(wxPoint(0, 0), mSize) : ToPixels(bounds);
+            Damage(drawn);
+        }
+    }
+
+    auto changed = std::count_if(mTiles.begin(), mTiles.end(), [](const Tile& tile) {return tile.mChanged;});
+    if(changed * 2 > long(mTiles.size()))
+    {
+        // Cheaper to draw everything than to go through the tiles,
+        // which stay damaged until a frame where little changes
+        MACHINE_TRACE("Machine", "FrameCache::DrawDirect");
+
+        graphics->PushState();
+        graphics->SetTransform(graphics->CreateMatrix());
+        graphics->DrawBitmap(mBackgroundBitmap, 0, 0, mSize.x, mSize.y);
+        graphics->PopState();
+
+        for (size_t i=0; i<dynamicComponents.size(); i++)
+        {
+            MACHINE_TRACE_TYPE("Draw", *dynamicComponents[i]);
+            dynamicComponents[i]->Draw(graphics);
+            mDrawnAsleep[i] = dynamicComponents[i]->IsAsleep();
+        }
+        return;
+    }
+
+    auto damaged = GetDamagedCount();
+    if(damaged > 0)
+    {
+        DrawDamaged(dynamicComponents);
+    }
+
+    DrawFrame(graphics, damaged > 0);
+}
+
+/**
+ * Draw the damaged tiles again into the frame image, with one
+ * offscreen context clipped to them, drawing each dynamic
+ * component that touches them once
+ * @param dynamicComponents Components drawn on top of the background
+ */
+void FrameCache::DrawDamaged(const std::vector<Component*>& dynamicComponents)
+{
+    MACHINE_TRACE("Machine", "FrameCache::DrawDamaged");
+
+    auto region = GetRegion(&Tile::mDamaged);
+    auto box = region.GetBox();
+
+    auto image = mBackground.GetSubImage(box);
+    {
+        // The context only writes to the image when it is destroyed
+        std::shared_ptr<wxGraphicsContext> context(wxGraphicsContext::Create(image));
+
+        wxRegion clip(region);
+        clip.Offset(-box.x, -box.y);
+        context->Clip(clip);
+
+        context->SetTransform(context->CreateMatrix(mTransform[0], mTransform[1], mTransform[2], mTransform[3],
+                                                    mTransform[4] - box.x, mTransform[5] - box.y));
+
+        for (size_t i=0; i<dynamicComponents.size(); i++)
+        {
+            if(region.Contains(mDrawnBounds[i]) != wxOutRegion)
+            {
+                MACHINE_TRACE_TYPE("Draw", *dynamicComponents[i]);
+                dynamicComponents[i]->Draw(context);
+                mDrawnAsleep[i] = dynamicComponents[i]->IsAsleep();
+            }
+        }
+    }
+
+    // Only the damaged tiles, the rest of the box is background
+    for (auto& tile : mTiles)
+    {
+        if(tile.mDamaged)
+        {
+            CopyToFrame(image, box.GetTopLeft(), tile.mRect);
+            tile.mDamaged = false;
+            tile.mStale = true;
+        }
+    }
+}
+
+/**
+ * Draw the frame image, the tiles as last drawn
+ * @param graphics Graphics device the frame is drawn onto
+ * @param changing Were any tiles drawn again this frame?
+ */
+void FrameCache::DrawFrame(std::shared_ptr<wxGraphicsContext> graphics, bool changing)
+{
+    auto stale = std::count_if(mTiles.begin(), mTiles.end(), [](const Tile& tile) {return tile.mStale;});
+
+    // Made again once the machine stops changing, or once so much
+    // has changed that going around the stale tiles costs more
+    if(stale > 0 && (!changing || stale * 2 > long(mTiles.size())))
+    {
+        MACHINE_TRACE("Machine", "FrameCache::FrameBitmap");
+        mFrameBitmap = graphics->CreateBitmapFromImage(mFrame);
+        for (auto& tile : mTiles)
+        {
+            tile.mStale = false;
+        }
+        stale = 0;
+    }
+
+    graphics->PushState();
+    graphics->SetTransform(graphics->CreateMatrix());
+
+    if(stale == 0)
+    {
+        graphics->DrawBitmap(mFrameBitmap, 0, 0, mSize.x, mSize.y);
+    }
+    else
+    {
+        auto staleRegion = GetRegion(&Tile::mStale);
+        auto box = staleRegion.GetBox();
+
+        wxRegion rest(wxRect(wxPoint(0, 0), mSize));
+        rest.Subtract(staleRegion);
+
+        graphics->PushState();
+        graphics->Clip(rest);
+        graphics->DrawBitmap(mFrameBitmap, 0, 0, mSize.x, mSize.y);
+        graphics->PopState();
+
+        auto fresh = graphics->CreateBitmapFromImage(mFrame.GetSubImage(box));
+        graphics->PushState();
+        graphics->Clip(staleRegion);
+        graphics->DrawBitmap(fresh, box.x, box.y, box.width, box.height);
+        graphics->PopState();
+    }
+
+    graphics->PopState();
+}
+
+/**
+ * Get the part of the frame covered by some of the tiles
+ * @param flag Which tiles, those with this flag set
+ * @return Region in pixels
+ */
+wxRegion FrameCache::GetRegion(bool Tile::* flag) const
+{
+    wxRegion region;
+    for (auto& tile : mTiles)
+    {
+        if(tile.*flag)
+        {
+            region.Union(tile.mRect);
+        }
+    }
+
+    return region;
+}
+
+/**
+ * Draw the background and split the frame into tiles,
+ * all of which are damaged.
+ * @param graphics Graphics device the frame is drawn onto
+ * @param staticComponents Components drawn into the background
+ * @param dynamicComponents Components drawn on top of the background
+ */
+void FrameCache::Build(std::shared_ptr<wxGraphicsContext> graphics, const std::vector<Component*>& staticComponents,
+                       const std::vector<Component*>& dynamicComponents)
+{
+    MACHINE_TRACE("Machine", "FrameCache::Build");
+
+    // Fully transparent image to draw the background into
+    mBackground = wxImage(mSize);
+    mBackground.InitAlpha();
+    std::memset(mBackground.GetAlpha(), 0, mSize.x * mSize.y);
+
+    if(!staticComponents.empty())
+    {
+        // The context only writes to the image when it is destroyed
+        std::shared_ptr<wxGraphicsContext> background(wxGraphicsContext::Create(mBackground));
+        background->SetTransform(background->CreateMatrix(mTransform[0], mTransform[1], mTransform[2],
+                                                          mTransform[3], mTransform[4], mTransform[5]));
+
+        for (auto component : staticComponents)
+        {
+            component->Draw(background);
+        }
+    }
+
+    mBackgroundBitmap = graphics->CreateBitmapFromImage(mBackground);
+
+    mFrame = mBackground.Copy();
+    mFrameBitmap = mBackgroundBitmap;
+
+    mColumns = (mSize.x + TileSize - 1) / TileSize;
+    mRows = (mSize.y + TileSize - 1) / TileSize;
+
+    mTiles.clear();
+    mTiles.resize(mColumns * mRows);
+    for (int row=0; row<mRows; row++)
+    {
+        for (int column=0; column<mColumns; column++)
+        {
+            auto& tile = mTiles[row * mColumns + column];
+            tile.mRect = wxRect(column * TileSize, row * TileSize, TileSize, TileSize)
+                .Intersect(wxRect(wxPoint(0, 0), mSize));
+        }
+    }
+
+    // Empty bounds make every component find its bounds again
+    mDrawnBounds.assign(dynamicComponents.size(), wxRect());
+    mDrawnAsleep.assign(dynamicComponents.size(), false);
+    mValid = true;
+}
+
+/**
+ * Convert bounds in machine coordinates to the pixels
+ * they cover with the transform the frame is drawn with
+ * @param bounds Bounds in centimeters
+ * @return Pixels covered, clipped to the frame
+ */
+wxRect FrameCache::ToPixels(const wxRect2DDouble& bounds)
+{
+    double left = 0, top = 0, right = 0, bottom = 0;
+
+    wxPoint2DDouble corners[] = {bounds.GetLeftTop(), bounds.GetRightTop(),
+                                 bounds.GetLeftBottom(), bounds.GetRightBottom()};
+    for (int i=0; i<4; i++)
+    {
+        auto& corner = corners[i];
+        auto x = mTransform[0] * corner.m_x + mTransform[2] * corner.m_y + mTransform[4];
+        auto y = mTransform[1] * corner.m_x + mTransform[3] * corner.m_y + mTransform[5];
+        if(i == 0)
+        {
+            left = right = x;
+            top = bottom = y;
+        }
+
+        left = std::min(left, x);
+        right = std::max(right, x);
+        top = std::min(top, y);
+        bottom = std::max(bottom, y);
+    }
+
+    wxRect pixels(wxPoint(int(std::floor(left)) - BoundsMargin, int(std::floor(top)) - BoundsMargin),
+                  wxPoint(int(std::ceil(right)) + BoundsMargin, int(std::ceil(bottom)) + BoundsMargin));
+    return pixels.Intersect(wxRect(wxPoint(0, 0), mSize));
+}
+
+/**
+ * Mark the tiles that a rectangle touches as damaged
+ * @param rect Rectangle in pixels
+ */
+void FrameCache::Damage(const wxRect& rect)
+{
+    if(rect.IsEmpty())
+    {
+        return;
+    }
+
+    auto firstColumn = std::max(rect.GetLeft() / TileSize, 0);
+    auto lastColumn = std::min(rect.GetRight() / TileSize, mColumns - 1);
+    auto firstRow = std::max(rect.GetTop() / TileSize, 0);
+    auto lastRow = std::min(rect.GetBottom() / TileSize, mRows - 1);
+
+    for (int row=firstRow; row<=lastRow; row++)
+    {
+        for (int column=firstColumn; column<=lastColumn; column++)
+        {
+            auto& tile = mTiles[row * mColumns + column];
+            tile.mDamaged = true;
+            tile.mChanged = true;
+        }
+    }
+}
+
+/**
+ * Copy part of a drawn image into the image of the whole frame
+ * @param image Image drawn
+ * @param origin Where the image is in the frame in pixels
+ * @param rect Part of the frame to copy, inside the image
+ */
+void FrameCache::CopyToFrame(const wxImage& image, const wxPoint& origin, const wxRect& rect)
+{
+    auto width = size_t(rect.width);
+    auto stride = size_t(mSize.x);
+    auto imageStride = size_t(image.GetWidth());
+
+    auto rgb = image.GetData();
+    auto alpha = image.GetAlpha();
+    for (int row=0; row<rect.height; row++)
+    {
+        auto offset = (rect.y + row) * stride + rect.x;
+        auto source = (rect.y - origin.y + row) * imageStride + rect.x - origin.x;
+        std::memcpy(mFrame.GetData() + offset * 3, rgb + source * 3, width * 3);
+        if(alpha != nullptr)
+        {
+            std::memcpy(mFrame.GetAlpha() + offset, alpha + source, width);
+        }
+    }
+}
+
+/**
+ * Get the number of tiles that will be drawn again next frame
+ * @return Number of damaged tiles
+ */
+int FrameCache::GetDamagedCount() const
+{
+    return int(std::count_if(mTiles.begin(), mTiles.end(), [](const Tile& tile) {return tile.mDamaged;}));
+}
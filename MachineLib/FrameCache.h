@@ -0,0 +1,144 @@
+/**
+ * @file FrameCache.h
+ * @author Max Tetlow
+ *
+ * Keeps the last drawn frame of a machine in tiles and
+ * draws again only the tiles where something changed.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_FRAMECACHE_H
+#define CANADIANEXPERIENCE_MACHINELIB_FRAMECACHE_H
+
+#include <vector>
+
+class Component;
+
+/**
+ * Keeps the last drawn frame of a machine in tiles and
+ * draws again only the tiles where something changed.
+ *
+ * The static components are drawn once into a background image.
+ * The frame is kept in an image of the whole frame, the background
+ * with the dynamic components drawn over it, and split into square
+ * tiles that track what changed. Every frame each dynamic component
+ * is asked whether it has changed since it was last drawn. The tiles
+ * under where a changed component was and where it is now are
+ * damaged. The damaged tiles are drawn again with one offscreen
+ * context clipped to all of them, in which each component that
+ * touches them is drawn once.
+ *
+ * The frame image is made into one bitmap when the machine stops
+ * changing, so a machine where nothing moves costs a single bitmap
+ * draw. While things move, the tiles drawn since that bitmap was
+ * made are drawn from a bitmap of just the part of the frame image
+ * around them, and the rest of the frame from the frame bitmap.
+ *
+ * A component that does not know its bounds damages the whole frame
+ * whenever it changes. When most of the frame is damaged in one frame
+ * it is drawn directly, which is cheaper than going through the tiles.
+ * Those tiles stay damaged and are drawn again together on the first
+ * frame where less changes.
+ */
+class FrameCache
+{
+private:
+    /// One square of the frame
+    struct Tile
+    {
+        /// Where the tile is in the frame in pixels
+        wxRect mRect;
+
+        /// Must the tile be drawn again?
+        bool mDamaged = true;
+
+        /// Was the tile damaged this frame?
+        bool mChanged = false;
+
+        /// Has the tile changed since the frame bitmap was made?
+        bool mStale = true;
+    };
+
+    /// The static components drawn into a transparent image
+    wxImage mBackground;
+
+    /// The background as a bitmap, for drawing the frame directly
+    wxGraphicsBitmap mBackgroundBitmap;
+
+    /// The tiles, row by row
+    std::vector<Tile> mTiles;
+
+    /// The whole frame, the tiles as last drawn
+    wxImage mFrame;
+
+    /// The frame image as a bitmap, as it was when the
+    /// tiles that are not stale were last drawn
+    wxGraphicsBitmap mFrameBitmap;
+
+    /// Number of tiles across the frame
+    int mColumns = 0;
+
+    /// Number of tiles down the frame
+    int mRows = 0;
+
+    /// Where each dynamic component was last drawn in pixels
+    std::vector<wxRect> mDrawnBounds;
+
+    /// Was each dynamic component asleep when it was last drawn?
+    std::vector<bool> mDrawnAsleep;
+
+    /// The transform the frame was drawn with
+    double mTransform[6] = {};
+
+    /// Size of the frame in pixels
+    wxSize mSize;
+
+    /// Is there a frame to draw from?
+    bool mValid = false;
+
+    void Build(std::shared_ptr<wxGraphicsContext> graphics, const std::vector<Component*>& staticComponents,
+               const std::vector<Component*>& dynamicComponents);
+
+    wxRect ToPixels(const wxRect2DDouble& bounds);
+
+    void Damage(const wxRect& rect);
+
+    void DrawDamaged(const std::vector<Component*>& dynamicComponents);
+
+    void DrawFrame(std::shared_ptr<wxGraphicsContext> graphics, bool changing);
+
+    wxRegion GetRegion(bool Tile::* flag) const;
+
+    void CopyToFrame(const wxImage& image, const wxPoint& origin, const wxRect& rect);
+
+public:
+    /// Width and height of a tile in pixels
+    static const int TileSize = 128;
+
+    /// Constructor
+    FrameCache() = default;
+
+    /// Copy constructor (disabled)
+    FrameCache(const FrameCache &) = delete;
+
+    /// Assignment operator
+    void operator=(const FrameCache &) = delete;
+
+    void Draw(std::shared_ptr<wxGraphicsContext> graphics, const std::vector<Component*>& staticComponents,
+              const std::vector<Component*>& dynamicComponents);
+
+    /**
+     * Throw away the cached frame, so the next
+     * Draw draws everything from scratch
+     */
+    void Invalidate() {mValid = false;}
+
+    int GetDamagedCount() const;
+
+    /**
+     * Get the number of tiles in the frame
+     * @return Number of tiles
+     */
+    int GetTileCount() const {return int(mTiles.size());}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_FRAMECACHE_H
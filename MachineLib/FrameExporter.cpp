@@ -0,0 +1,270 @@
+/**
+ * @file FrameExporter.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "FrameExporter.h"
+#include "BoundedQueue.h"
+#include "Machine.h"
+#include "MachineFactory.h"
+#include "MachineSnapshot.h"
+#include "Component.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Pixels per centimeter when the machine has no bounds to fit
+const double DefaultPixelsPerCentimeter = 1.5;
+
+/// Fraction of the frame left empty around the machine
+const double ViewMargin = 0.05;
+
+/// A snapshot waiting to be drawn, with its frame number
+typedef std::pair<int, std::shared_ptr<MachineSnapshot>> SnapshotItem;
+
+/// A drawn frame waiting to be written, with its frame number
+typedef std::pair<int, std::shared_ptr<wxImage>> ImageItem;
+
+/**
+ * Seconds since a start time
+ * @param start Start time
+ * @return Seconds elapsed
+ */
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Constructor
+ * @param resourcesDir Path to the resources directory
+ */
+FrameExporter::FrameExporter(std::wstring resourcesDir) : mResourcesDir(resourcesDir)
+{
+}
+
+/**
+ * Build the machine to export, and the copy it is drawn with
+ * @param machine Machine number
+ * @return true if the machine was built, false if there
+ * is no machine with this number
+ */
+bool FrameExporter::SetMachineNumber(int machine)
+{
+    MachineFactory factory(mResourcesDir);
+    factory.LoadImages();
+    mMachine = factory.Create(machine);
+    mDrawMachine = mMachine != nullptr ? factory.Create(machine) : nullptr;
+    return mMachine != nullptr;
+}
+
+/**
+ * Step the simulated machine in regions
+ * @param threads Threads to step the regions with, 0 for one world
+ * @see Machine::SetThreads
+ */
+void FrameExporter::SetRegions(int threads)
+{
+    mMachine->SetThreads(threads);
+}
+
+/**
+ * Get the file name of one frame of a PNG export
+ * @param prefix Path and start of the file names
+ * @param frame Frame number
+ * @return File name, the prefix followed by a five digit frame number
+ */
+std::string FrameExporter::GetFrameName(const std::string& prefix, int frame)
+{
+    char number[16];
+    std::snprintf(number, sizeof(number), "%05d", frame);
+    return prefix + number + ".png";
+}
+
+/**
+ * Export frames of the machine from time zero.
+ *
+ * The view is fit to the bounds of the components at time
+ * zero, centered, with the y axis up.
+ * @param frames Number of frames to export
+ * @param path For Format::Png the path and start of the file
+ * names, see GetFrameName. For Format::Raw the file to write the
+ * frames to, one after another, with no header.
+ * @param format Format to write the frames in
+ * @return true if every frame was written, false if not or if
+ * called in a GUI application, where the main thread also draws
+ */
+bool FrameExporter::Export(int frames, const std::string& path, Format format)
+{
+    MACHINE_TRACE("Export", "FrameExporter::Export");
+
+    if(wxTheApp != nullptr && wxTheApp->IsGUI())
+    {
+        return false;
+    }
+
+    mMachine->Reset();
+    mDrawMachine->Reset();
+
+    mSimulateSeconds = 0;
+    mRasterizeSeconds = 0;
+    mEncodeSeconds = 0;
+    mFramesWritten = 0;
+
+    std::ofstream raw;
+    if(format == Format::Raw)
+    {
+        raw.open(path, std::ios::binary);
+        if(!raw)
+        {
+            return false;
+        }
+    }
+
+    // Fit the view to the machine, centimeters to pixels
+    wxRect2DDouble bounds;
+    bool first = true;
+    for(auto component : mDrawMachine->GetComponents())
+    {
+        auto rect = component->GetBounds();
+        if(!rect.IsEmpty())
+        {
+            if(first)
+            {
+                bounds = rect;
+                first = false;
+            }
+            else
+            {
+                bounds.Union(rect);
+            }
+        }
+    }
+
+    double scale = DefaultPixelsPerCentimeter;
+    wxPoint2DDouble center(0, mHeight / 2.0 / scale);
+    if(!first)
+    {
+        scale = std::min(mWidth / bounds.m_width, mHeight / bounds.m_height) * (1 - 2 * ViewMargin);
+        center = bounds.GetCentre();
+    }
+
+    BoundedQueue<SnapshotItem> snapshots(mQueueDepth);
+    BoundedQueue<ImageItem> images(mQueueDepth);
+
+    std::thread simulate([this, frames, &snapshots]() {
+        for(int frame=0; frame<frames; frame++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            std::shared_ptr<MachineSnapshot> snapshot;
+            {
+                MACHINE_TRACE("Export", "FrameExporter::Simulate");
+                mMachine->Advance(1.0 / mFrameRate);
+                snapshot = mMachine->Snapshot(frame);
+            }
+            mSimulateSeconds += SecondsSince(start);
+
+            if(!snapshots.Push(SnapshotItem(frame, snapshot)))
+            {
+                break;
+            }
+        }
+
+        snapshots.Close();
+    });
+
+    std::thread rasterize([this, scale, center, &snapshots, &images]() {
+        SnapshotItem item;
+        while(snapshots.Pop(item))
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto image = std::make_shared<wxImage>(mWidth, mHeight, false);
+            {
+                MACHINE_TRACE("Export", "FrameExporter::Rasterize");
+                item.second->Apply(mDrawMachine.get());
+
+                image->SetRGB(wxRect(0, 0, mWidth, mHeight), 255, 255, 255);
+                image->InitAlpha();
+                std::memset(image->GetAlpha(), 255, size_t(mWidth) * mHeight);
+
+                // The context only writes to the image when it is destroyed
+                std::shared_ptr<wxGraphicsContext> graphics(wxGraphicsContext::Create(*image));
+                graphics->Translate(mWidth / 2.0 - scale * center.m_x, mHeight / 2.0 + scale * center.m_y);
+                graphics->Scale(scale, -scale);
+                mDrawMachine->Draw(graphics);
+            }
+            mRasterizeSeconds += SecondsSince(start);
+
+            if(!images.Push(ImageItem(item.first, image)))
+            {
+                // The encoder has failed, stop the simulation too
+                snapshots.Close();
+                break;
+            }
+        }
+
+        images.Close();
+    });
+
+    bool written = true;
+    std::thread encode([this, format, &path, &raw, &images, &written]() {
+        // Errors are reported by the return value, not wxLog from this thread
+        wxLogNull noLog;
+
+        ImageItem item;
+        std::vector<unsigned char> rgba;
+        while(images.Pop(item))
+        {
+            auto start = std::chrono::steady_clock::now();
+            {
+                MACHINE_TRACE("Export", "FrameExporter::Encode");
+                auto& image = *item.second;
+                if(format == Format::Png)
+                {
+                    written = image.SaveFile(GetFrameName(path, item.first), wxBITMAP_TYPE_PNG);
+                }
+                else
+                {
+                    size_t pixels = size_t(image.GetWidth()) * image.GetHeight();
+                    auto rgb = image.GetData();
+                    auto alpha = image.GetAlpha();
+
+                    rgba.resize(pixels * 4);
+                    for(size_t p=0; p<pixels; p++)
+                    {
+                        rgba[p * 4] = rgb[p * 3];
+                        rgba[p * 4 + 1] = rgb[p * 3 + 1];
+                        rgba[p * 4 + 2] = rgb[p * 3 + 2];
+                        rgba[p * 4 + 3] = alpha != nullptr ? alpha[p] : 255;
+                    }
+
+                    raw.write((const char*)rgba.data(), rgba.size());
+                    written = raw.good();
+                }
+            }
+            mEncodeSeconds += SecondsSince(start);
+
+            if(!written)
+            {
+                images.Close();
+                break;
+            }
+
+            mFramesWritten++;
+        }
+    });
+
+    simulate.join();
+    rasterize.join();
+    encode.join();
+
+    return written && mFramesWritten == frames;
+}
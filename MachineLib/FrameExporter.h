@@ -0,0 +1,150 @@
+/**
+ * @file FrameExporter.h
+ * @author Max Tetlow
+ *
+ * Renders the frames of a machine without a window and
+ * writes them as PNG files or a raw RGBA video stream.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_FRAMEEXPORTER_H
+#define CANADIANEXPERIENCE_MACHINELIB_FRAMEEXPORTER_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+class Machine;
+class MachineSnapshot;
+
+/**
+ * Renders the frames of a machine without a window and
+ * writes them as PNG files or a raw RGBA video stream.
+ *
+ * Exporting runs as three stages, each on its own thread, with
+ * a bounded queue between them:
+ *
+ * 1. Simulate advances the machine a frame and takes a snapshot.
+ * 2. Rasterize applies the snapshot to a second copy of the machine
+ *    and draws it into an offscreen wxImage.
+ * 3. Encode writes the image as a PNG or appends it to the stream.
+ *
+ * While one frame is encoded the next is drawn and the one after
+ * that simulated, so frames come out at the rate of the slowest
+ * stage rather than the sum of all three. The queues hold only a
+ * few frames, so a slow stage holds back the ones before it.
+ *
+ * Frames are drawn at the pose of the last physics step, not
+ * interpolated between steps as the demo draws them, since applying
+ * a snapshot sets the machine clock to a whole step. This is exact
+ * when the frame rate divides the physics step rate.
+ *
+ * Only for programs without a GUI, like MachineRunner. The rasterize
+ * thread draws through the shared image cache, bitmaps and fonts,
+ * whose wx reference counts are not thread safe, so nothing else may
+ * draw while an export runs. Export fails in a GUI application.
+ */
+class FrameExporter
+{
+public:
+    /// The file formats frames can be written in
+    enum class Format {Png, Raw};
+
+private:
+    /// Path to the resources directory
+    std::wstring mResourcesDir;
+
+    /// The machine that is simulated
+    std::shared_ptr<Machine> mMachine;
+
+    /// The copy of the machine snapshots are drawn with
+    std::shared_ptr<Machine> mDrawMachine;
+
+    /// The frame rate in frames per second
+    double mFrameRate = 30;
+
+    /// Width of a frame in pixels
+    int mWidth = 1280;
+
+    /// Height of a frame in pixels
+    int mHeight = 720;
+
+    /// Frames each queue between two stages can hold
+    int mQueueDepth = 4;
+
+    /// Seconds spent simulating in the last export
+    double mSimulateSeconds = 0;
+
+    /// Seconds spent drawing in the last export
+    double mRasterizeSeconds = 0;
+
+    /// Seconds spent encoding in the last export
+    double mEncodeSeconds = 0;
+
+    /// Number of frames written in the last export
+    int mFramesWritten = 0;
+
+public:
+    FrameExporter(std::wstring resourcesDir);
+
+    /// Default constructor (disabled)
+    FrameExporter() = delete;
+
+    /// Copy constructor (disabled)
+    FrameExporter(const FrameExporter &) = delete;
+
+    /// Assignment operator
+    void operator=(const FrameExporter &) = delete;
+
+    bool SetMachineNumber(int machine);
+
+    void SetRegions(int threads);
+
+    /**
+     * Set the frame rate the machine is exported at
+     * @param rate Frame rate in frames per second
+     */
+    void SetFrameRate(double rate) {mFrameRate = rate;}
+
+    /**
+     * Set the size of the exported frames
+     * @param width Width in pixels
+     * @param height Height in pixels
+     */
+    void SetSize(int width, int height) {mWidth = width; mHeight = height;}
+
+    /**
+     * Set how many frames can wait between two stages
+     * @param depth Frames per queue
+     */
+    void SetQueueDepth(int depth) {mQueueDepth = depth;}
+
+    bool Export(int frames, const std::string& path, Format format);
+
+    static std::string GetFrameName(const std::string& prefix, int frame);
+
+    /**
+     * Get the number of frames written in the last export
+     * @return Number of frames
+     */
+    int GetFramesWritten() const {return mFramesWritten;}
+
+    /**
+     * Get the time the simulate stage was busy in the last export
+     * @return Time in seconds
+     */
+    double GetSimulateSeconds() const {return mSimulateSeconds;}
+
+    /**
+     * Get the time the rasterize stage was busy in the last export
+     * @return Time in seconds
+     */
+    double GetRasterizeSeconds() const {return mRasterizeSeconds;}
+
+    /**
+     * Get the time the encode stage was busy in the last export
+     * @return Time in seconds
+     */
+    double GetEncodeSeconds() const {return mEncodeSeconds;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_FRAMEEXPORTER_H
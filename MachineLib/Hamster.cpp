@@ -92,6 +92,50 @@ void Hamster::Draw(std::shared_ptr<wxGraphicsContext> graphics)
     }
 
     graphics->PopState();
+
+    mDrawnRotation = mRotation;
+    mDrawnIndex = hamsterIndex;
+    mDrawnBackwards = mSpeed < 0;
+    mDrawn = true;
+}
+
+/**
+ * function that gets the rectangle the hamster draws in
+ *
+ * The hamster image is centered on the wheel, so facing
+ * backwards does not change where it draws.
+ * @return the bounds in centimeters
+ */
+wxRect2DDouble Hamster::GetBounds()
+{
+    auto bounds = mPolygon.GetBounds(mLocation.x, mLocation.y, 0);
+    bounds.Union(mWheel.GetBounds(mLocation.x + WheelCenter.x, mLocation.y + WheelCenter.y, mRotation));
+    bounds.Union(mHamsters[hamsterIndex].GetBounds(mLocation.x + WheelCenter.x, mLocation.y + WheelCenter.y, 0));
+    return bounds;
+}
+
+/**
+ * function that tells if the hamster would draw differently than last time
+ * @return true if the wheel or hamster changed since it was drawn
+ */
+bool Hamster::IsChanged()
+{
+    return !mDrawn || mRotation != mDrawnRotation || hamsterIndex != mDrawnIndex ||
+        (mSpeed < 0) != mDrawnBackwards;
+}
+
+/**
+ * Create the wx objects the hamster draws with
+ */
+void Hamster::CreateGraphics()
+{
+    mPolygon.CreateGraphics();
+    mCage.CreateGraphics();
+    mWheel.CreateGraphics();
+    for(auto& hamster : mHamsters)
+    {
+        hamster.CreateGraphics();
+    }
 }
 
 /**
@@ -223,3 +267,24 @@ void Hamster::SetInitiallyRunning(bool sleep)
     }
 }
 
+/**
+ * Save the hamster wheel rotation and running state
+ * @param state Vector to append the state values to
+ */
+void Hamster::SaveState(std::vector<double>& state)
+{
+    state.push_back(mRotation);
+    state.push_back(hamsterIndex);
+    state.push_back(isAsleep ? 1 : 0);
+}
+
+/**
+ * Restore the state saved by SaveState
+ * @param state Iterator to read the state values from
+ */
+void Hamster::RestoreState(std::vector<double>::const_iterator& state)
+{
+    mRotation = *state++;
+    hamsterIndex = int(*state++);
+    isAsleep = *state++ != 0;
+}
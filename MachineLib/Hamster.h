@@ -16,7 +16,7 @@
 /**
  * function that represents a hamster in the machine
  */
-class Hamster : public Component, public b2ContactListener
+class Hamster final : public Component, public b2ContactListener
 {
 private:
 
@@ -53,6 +53,18 @@ private:
     ///location of the cage
     wxPoint mLocation;
 
+    ///wheel rotation the hamster was last drawn with
+    double mDrawnRotation = 0;
+
+    ///hamster image index the hamster was last drawn with
+    int mDrawnIndex = 0;
+
+    ///weather or not the hamster was last drawn facing backwards
+    bool mDrawnBackwards = false;
+
+    ///weather or not the hamster has been drawn
+    bool mDrawn = false;
+
 public:
     Hamster(std::wstring imagesDir);
 
@@ -65,6 +77,17 @@ public:
     cse335::PhysicsPolygon * GetPolygon() override;
     void BeginContact(b2Contact *contact) override;
     void Update(double elapsed) override;
+    void SaveState(std::vector<double>& state) override;
+    void RestoreState(std::vector<double>::const_iterator& state) override;
+    wxRect2DDouble GetBounds() override;
+    bool IsChanged() override;
+    void CreateGraphics() override;
+
+    /**
+     * checks if the hamster is not running and nothing awake is touching the cage
+     * @return true if the hamster is at rest
+     */
+    bool IsResting() override {return !isAsleep && mCage.IsResting();}
 
 
     /**
@@ -81,6 +104,12 @@ public:
      */
     void SetSpeed(double speed) {mSpeed = speed;}
 
+    /**
+     * gets the speed the hamster runs at
+     * @return the speed of the hamster
+     */
+    double GetSpeed() {return mSpeed;}
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_HAMSTER_H
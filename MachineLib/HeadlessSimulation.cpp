@@ -0,0 +1,111 @@
+/**
+ * @file HeadlessSimulation.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "HeadlessSimulation.h"
+#include "Machine.h"
+#include "MachineFactory.h"
+#include "Trajectory.h"
+
+#include <b2_body.h>
+#include <b2_world.h>
+
+/**
+ * Constructor
+ * @param resourcesDir Path to the resources directory
+ */
+HeadlessSimulation::HeadlessSimulation(std::wstring resourcesDir) : mResourcesDir(resourcesDir)
+{
+}
+
+/**
+ * Build the machine to run
+ * @param machine Machine number
+ * @return true if the machine was built, false if there
+ * is no machine with this number
+ */
+bool HeadlessSimulation::SetMachineNumber(int machine)
+{
+    MachineFactory factory(mResourcesDir);
+    factory.LoadImages();
+    auto created = factory.Create(machine);
+    if(created == nullptr)
+    {
+        return false;
+    }
+
+    mMachine = created;
+    mFrame = 0;
+    return true;
+}
+
+/**
+ * Reset the machine to time zero
+ */
+void HeadlessSimulation::Reset()
+{
+    mMachine->Reset();
+    mFrame = 0;
+}
+
+/**
+ * Step the machine some number of frames
+ * @param frames Number of frames to step
+ * @param out Stream to write the body states to after
+ * each frame, or nullptr to not write anything
+ * @param trajectory Trajectory to record each frame
+ * into, or nullptr to not record
+ */
+void HeadlessSimulation::Run(int frames, std::ostream* out, Trajectory* trajectory)
+{
+    for(int i=0; i<frames; i++)
+    {
+        mMachine->Advance(1.0 / mFrameRate);
+        mFrame++;
+
+        if(out != nullptr)
+        {
+            WriteFrame(*out);
+        }
+
+        if(trajectory != nullptr)
+        {
+            trajectory->Record(mMachine.get());
+        }
+    }
+}
+
+/**
+ * Write the state of every body for the current frame.
+ *
+ * One line per body: frame, body index, position x and y in
+ * meters, angle in radians, linear velocity x and y and angular
+ * velocity, and 1 if the body is awake.
+ * @param out Stream to write to
+ */
+void HeadlessSimulation::WriteFrame(std::ostream& out)
+{
+    int index = 0;
+    for(auto body : mMachine->GetBodies())
+    {
+        auto position = body->GetPosition();
+        auto velocity = body->GetLinearVelocity();
+
+        out << mFrame << ' ' << index << ' '
+            << position.x << ' ' << position.y << ' ' << body->GetAngle() << ' '
+            << velocity.x << ' ' << velocity.y << ' ' << body->GetAngularVelocity() << ' '
+            << (body->IsAwake() ? 1 : 0) << '\n';
+        index++;
+    }
+}
+
+/**
+ * Get the number of bodies in the physics world
+ * @return Number of bodies
+ */
+int HeadlessSimulation::GetBodyCount()
+{
+    return int(mMachine->GetBodies().size());
+}
@@ -0,0 +1,80 @@
+/**
+ * @file HeadlessSimulation.h
+ * @author Max Tetlow
+ *
+ * Runs a machine without any window or drawing.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_HEADLESSSIMULATION_H
+#define CANADIANEXPERIENCE_MACHINELIB_HEADLESSSIMULATION_H
+
+#include <memory>
+#include <string>
+#include <ostream>
+
+class Machine;
+class Trajectory;
+
+/**
+ * Runs a machine without any window or drawing.
+ *
+ * The machine is advanced at a fixed frame rate and the
+ * state of every body can be written out for each frame.
+ */
+class HeadlessSimulation
+{
+private:
+    /// Path to the resources directory
+    std::wstring mResourcesDir;
+
+    /// The machine we are running
+    std::shared_ptr<Machine> mMachine;
+
+    /// The frame rate in frames per second
+    double mFrameRate = 30;
+
+    /// The current frame
+    int mFrame = 0;
+
+public:
+    HeadlessSimulation(std::wstring resourcesDir);
+
+    /// Default constructor (disabled)
+    HeadlessSimulation() = delete;
+
+    /// Copy constructor (disabled)
+    HeadlessSimulation(const HeadlessSimulation &) = delete;
+
+    /// Assignment operator
+    void operator=(const HeadlessSimulation &) = delete;
+
+    bool SetMachineNumber(int machine);
+
+    /**
+     * Set the frame rate the machine is stepped at
+     * @param rate Frame rate in frames per second
+     */
+    void SetFrameRate(double rate) {mFrameRate = rate;}
+
+    void Reset();
+
+    void Run(int frames, std::ostream* out = nullptr, Trajectory* trajectory = nullptr);
+
+    void WriteFrame(std::ostream& out);
+
+    int GetBodyCount();
+
+    /**
+     * Get the machine we are running
+     * @return Machine object
+     */
+    std::shared_ptr<Machine> GetMachine() {return mMachine;}
+
+    /**
+     * Get the current frame
+     * @return Frame number
+     */
+    int GetFrame() {return mFrame;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_HEADLESSSIMULATION_H
@@ -0,0 +1,300 @@
+/**
+ * @file ImageCache.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "ImageCache.h"
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+using namespace cse335;
+
+/// The images that have been loaded, keyed by canonical path
+std::map<std::wstring, std::weak_ptr<CachedImage>> ImageCache::mImages;
+
+/// Protects mImages
+std::mutex ImageCache::mMutex;
+
+/// Loads that found the image already loaded
+std::atomic<uint64_t> ImageCache::mHits(0);
+
+/// Loads that had to read the image from its file
+std::atomic<uint64_t> ImageCache::mMisses(0);
+
+/// Directories already packed into an atlas
+std::vector<std::wstring> ImageCache::mAtlasDirectories;
+
+/// Images packed into an atlas, kept alive so they stay packed
+std::vector<std::shared_ptr<CachedImage>> ImageCache::mAtlasImages;
+
+/**
+ * Constructor
+ */
+CachedImage::CachedImage()
+{
+}
+
+/**
+ * Constructor, an image with every pixel black and fully transparent
+ * @param width Width in pixels
+ * @param height Height in pixels
+ */
+CachedImage::CachedImage(int width, int height) :
+    mWidth(width), mHeight(height), mData(size_t(width) * height * 3, 0), mAlpha(size_t(width) * height, 0)
+{
+}
+
+/**
+ * Decode an image file into this image.
+ *
+ * Safe on any thread, the wxImage it is decoded with
+ * never leaves this function. A mask color becomes
+ * an alpha channel.
+ * @param filename Image filename
+ * @return true if the image was decoded
+ */
+bool CachedImage::LoadFile(const std::wstring& filename)
+{
+    wxImage image;
+    if(!image.LoadFile(filename, wxBITMAP_TYPE_ANY))
+    {
+        return false;
+    }
+
+    if(image.HasMask() && !image.HasAlpha())
+    {
+        image.InitAlpha();
+    }
+
+    mWidth = image.GetWidth();
+    mHeight = image.GetHeight();
+
+    auto pixels = size_t(mWidth) * mHeight;
+    mData.assign(image.GetData(), image.GetData() + pixels * 3);
+    if(image.HasAlpha())
+    {
+        mAlpha.assign(image.GetAlpha(), image.GetAlpha() + pixels);
+    }
+    else
+    {
+        mAlpha.clear();
+    }
+
+    return true;
+}
+
+/**
+ * Get the image as a wxImage, creating it the first time.
+ *
+ * Only call this on the thread that draws. The wxImage
+ * uses the pixel buffers of this image rather than a copy.
+ * @return Image
+ */
+const wxImage& CachedImage::GetImage()
+{
+    if(!mImage.IsOk() && IsOk())
+    {
+        mImage = wxImage(mWidth, mHeight, mData.data(), GetAlpha(), true);
+    }
+
+    return mImage;
+}
+
+/**
+ * Get the graphics bitmap for this image, creating
+ * it the first time it is drawn with a renderer.
+ * @param graphics Graphics context we are drawing on
+ * @return Graphics bitmap
+ */
+wxGraphicsBitmap CachedImage::GetBitmap(std::shared_ptr<wxGraphicsContext> graphics)
+{
+    auto& bitmap = mBitmaps[graphics->GetRenderer()];
+    if(bitmap.IsNull())
+    {
+        bitmap = graphics->CreateBitmapFromImage(GetImage());
+    }
+
+    return bitmap;
+}
+
+/**
+ * Load an image, sharing it if it has already been loaded
+ * @param filename Image filename
+ * @return Shared image or nullptr if the image could not be loaded
+ */
+std::shared_ptr<CachedImage> ImageCache::Load(const std::wstring& filename)
+{
+    auto path = Canonical(filename);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto cached = mImages.find(path);
+        if(cached != mImages.end())
+        {
+            auto image = cached->second.lock();
+            if(image != nullptr)
+            {
+                mHits.fetch_add(1, std::memory_order_relaxed);
+                return image;
+            }
+        }
+    }
+
+    mMisses.fetch_add(1, std::memory_order_relaxed);
+
+    // Decoded without the lock, so machines built on several
+    // threads load their images at the same time
+    auto image = std::make_shared<CachedImage>();
+    {
+        // Prevent error popup from wxWidgets
+        wxLogNull logNo;
+
+        if(!image->LoadFile(path))
+        {
+            return nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // Another thread may have loaded the same image meanwhile
+    auto cached = mImages.find(path);
+    if(cached != mImages.end())
+    {
+        auto other = cached->second.lock();
+        if(other != nullptr)
+        {
+            return other;
+        }
+    }
+
+    // Take the chance to drop any images nobody uses anymore
+    for(auto i = mImages.begin(); i != mImages.end(); )
+    {
+        i = i->second.expired() ? mImages.erase(i) : std::next(i);
+    }
+
+    mImages[path] = image;
+    return image;
+}
+
+/**
+ * Load every PNG image in a directory and pack them
+ * into a shared texture atlas.
+ *
+ * Polygons that later load any of these images draw them from
+ * the atlas, so a whole machine draws from a handful of bitmaps
+ * instead of one per image. Loading the same directory again
+ * does nothing. Images that are already loaded and in use are
+ * left alone rather than packed.
+ * @param directory Directory containing the images
+ */
+void ImageCache::LoadAtlas(const std::wstring& directory)
+{
+    auto path = Canonical(directory);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(std::find(mAtlasDirectories.begin(), mAtlasDirectories.end(), path) != mAtlasDirectories.end())
+    {
+        return;
+    }
+
+    mAtlasDirectories.push_back(path);
+
+    // Prevent error popup from wxWidgets
+    wxLogNull logNo;
+
+    wxArrayString files;
+    if(!wxDir::Exists(path))
+    {
+        return;
+    }
+
+    wxDir::GetAllFiles(path, &files, L"*.png", wxDIR_FILES);
+    files.Sort();
+
+    std::vector<std::shared_ptr<CachedImage>> images;
+    for(auto& file : files)
+    {
+        auto filename = Canonical(file.ToStdWstring());
+        auto cached = mImages.find(filename);
+        if(cached != mImages.end() && !cached->second.expired())
+        {
+            continue;
+        }
+
+        auto image = std::make_shared<CachedImage>();
+        if(image->LoadFile(filename))
+        {
+            mImages[filename] = image;
+            images.push_back(image);
+        }
+    }
+
+    TextureAtlas::Pack(images);
+    mAtlasImages.insert(mAtlasImages.end(), images.begin(), images.end());
+}
+
+/**
+ * Get the number of distinct images currently loaded
+ * @return Number of images
+ */
+size_t ImageCache::GetCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    size_t count = 0;
+    for(auto& image : mImages)
+    {
+        if(!image.second.expired())
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Get the fraction of loads that found the image already loaded
+ * @return Hit rate from 0 to 1, 0 if nothing has been loaded
+ */
+double ImageCache::GetHitRate()
+{
+    auto hits = mHits.load(std::memory_order_relaxed);
+    auto total = hits + mMisses.load(std::memory_order_relaxed);
+    return total > 0 ? double(hits) / total : 0;
+}
+
+/**
+ * Forget all of the cached images.
+ *
+ * Images still in use stay alive for the polygons using them,
+ * but the next load of any file decodes it from disk again.
+ */
+void ImageCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mImages.clear();
+    mAtlasDirectories.clear();
+    mAtlasImages.clear();
+}
+
+/**
+ * Get the canonical form of a path, so the same
+ * file is always found under the same key
+ * @param filename Path to a file or directory
+ * @return Canonical path
+ */
+std::wstring ImageCache::Canonical(const std::wstring& filename)
+{
+    wxFileName name(filename);
+    name.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE | wxPATH_NORM_LONG);
+    return name.GetFullPath().ToStdWstring();
+}
@@ -0,0 +1,189 @@
+/**
+ * @file ImageCache.h
+ * @author Max Tetlow
+ *
+ * Process-wide cache of decoded images so polygons that
+ * use the same texture share one copy of it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cse335 {
+
+/**
+ * A decoded image shared by every polygon that uses it.
+ *
+ * The pixels are plain buffers, so an image can be decoded
+ * on any thread. The wxImage and the graphics bitmaps made
+ * from it are only created on the thread that draws, the
+ * first time they are needed, and kept for every polygon
+ * that draws the image after.
+ */
+class CachedImage {
+private:
+    /// Width in pixels
+    int mWidth = 0;
+
+    /// Height in pixels
+    int mHeight = 0;
+
+    /// Red, green and blue of each pixel, row by row
+    std::vector<unsigned char> mData;
+
+    /// Alpha of each pixel, empty if the image is opaque
+    std::vector<unsigned char> mAlpha;
+
+    /// The pixels as a wxImage, created when first drawn
+    wxImage mImage;
+
+    /// Graphics bitmaps created from this image, one per renderer
+    std::map<wxGraphicsRenderer*, wxGraphicsBitmap> mBitmaps;
+
+    /// Atlas page this image has been packed into, if any
+    std::shared_ptr<CachedImage> mAtlas;
+
+    /// Where this image is in the atlas page
+    wxRect mAtlasRect;
+
+public:
+    CachedImage();
+
+    CachedImage(int width, int height);
+
+    /// Copy constructor (disabled)
+    CachedImage(const CachedImage &) = delete;
+
+    /// Assignment operator
+    void operator=(const CachedImage &) = delete;
+
+    bool LoadFile(const std::wstring& filename);
+
+    const wxImage& GetImage();
+
+    wxGraphicsBitmap GetBitmap(std::shared_ptr<wxGraphicsContext> graphics);
+
+    /**
+     * Has the image been decoded?
+     * @return true if the image has pixels
+     */
+    bool IsOk() const {return mWidth > 0 && mHeight > 0;}
+
+    /**
+     * Get the width of the image
+     * @return Width in pixels
+     */
+    int GetWidth() const {return mWidth;}
+
+    /**
+     * Get the height of the image
+     * @return Height in pixels
+     */
+    int GetHeight() const {return mHeight;}
+
+    /**
+     * Get the red, green and blue of each pixel
+     * @return Three bytes per pixel, row by row
+     */
+    unsigned char* GetData() {return mData.data();}
+
+    /**
+     * Get the alpha of each pixel
+     * @return One byte per pixel, nullptr if the image is opaque
+     */
+    unsigned char* GetAlpha() {return mAlpha.empty() ? nullptr : mAlpha.data();}
+
+    /**
+     * Get the red value of a pixel
+     * @param x X in pixels
+     * @param y Y in pixels
+     * @return Red from 0 to 255
+     */
+    unsigned char GetRed(int x, int y) const {return mData[(y * mWidth + x) * 3];}
+
+    /**
+     * Get the green value of a pixel
+     * @param x X in pixels
+     * @param y Y in pixels
+     * @return Green from 0 to 255
+     */
+    unsigned char GetGreen(int x, int y) const {return mData[(y * mWidth + x) * 3 + 1];}
+
+    /**
+     * Get the blue value of a pixel
+     * @param x X in pixels
+     * @param y Y in pixels
+     * @return Blue from 0 to 255
+     */
+    unsigned char GetBlue(int x, int y) const {return mData[(y * mWidth + x) * 3 + 2];}
+
+    /**
+     * Set the atlas page this image has been packed into
+     * @param atlas Atlas page
+     * @param rect Where this image is in the page
+     */
+    void SetAtlas(std::shared_ptr<CachedImage> atlas, const wxRect& rect) {mAtlas = atlas; mAtlasRect = rect;}
+
+    /**
+     * Get the atlas page this image has been packed into
+     * @return Atlas page or nullptr if the image is not in an atlas
+     */
+    const std::shared_ptr<CachedImage>& GetAtlas() const {return mAtlas;}
+
+    /**
+     * Get where this image is in its atlas page
+     * @return Rectangle in atlas page pixels
+     */
+    const wxRect& GetAtlasRect() const {return mAtlasRect;}
+};
+
+/**
+ * Process-wide cache of decoded images keyed by canonical path.
+ *
+ * The cache only holds weak references. An image is freed
+ * when the last polygon using it is destroyed.
+ */
+class ImageCache {
+private:
+    /// The images that have been loaded, keyed by canonical path
+    static std::map<std::wstring, std::weak_ptr<CachedImage>> mImages;
+
+    /// Protects mImages
+    static std::mutex mMutex;
+
+    /// Loads that found the image already loaded
+    static std::atomic<uint64_t> mHits;
+
+    /// Loads that had to read the image from its file
+    static std::atomic<uint64_t> mMisses;
+
+    /// Directories already packed into an atlas
+    static std::vector<std::wstring> mAtlasDirectories;
+
+    /// Images packed into an atlas, kept alive so they stay packed
+    static std::vector<std::shared_ptr<CachedImage>> mAtlasImages;
+
+    static std::wstring Canonical(const std::wstring& filename);
+
+public:
+    /// Constructor (disabled)
+    ImageCache() = delete;
+
+    static std::shared_ptr<CachedImage> Load(const std::wstring& filename);
+
+    static void LoadAtlas(const std::wstring& directory);
+
+    static size_t GetCount();
+
+    static double GetHitRate();
+
+    static void Clear();
+};
+
+}
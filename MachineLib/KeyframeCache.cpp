@@ -0,0 +1,129 @@
+/**
+ * @file KeyframeCache.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "KeyframeCache.h"
+#include "MachineSnapshot.h"
+
+/**
+ * Constructor
+ */
+KeyframeCache::KeyframeCache()
+{
+}
+
+/**
+ * Set the number of frames between keyframes.
+ *
+ * Keyframes that are not on the new interval are discarded.
+ * @param interval Interval in frames, must be at least 1
+ */
+void KeyframeCache::SetInterval(int interval)
+{
+    mInterval = interval < 1 ? 1 : interval;
+    Discard();
+    Enforce();
+}
+
+/**
+ * Discard any keyframes that are not on the current interval
+ */
+void KeyframeCache::Discard()
+{
+    for(auto keyframe = mKeyframes.begin(); keyframe != mKeyframes.end(); )
+    {
+        if(keyframe->first % mInterval != 0)
+        {
+            mSize -= keyframe->second->GetSize();
+            keyframe = mKeyframes.erase(keyframe);
+        }
+        else
+        {
+            ++keyframe;
+        }
+    }
+}
+
+/**
+ * Set the maximum memory the keyframes may use
+ * @param budget Budget in bytes
+ */
+void KeyframeCache::SetMemoryBudget(size_t budget)
+{
+    mBudget = budget;
+    Enforce();
+}
+
+/**
+ * Should a keyframe be taken at some frame?
+ * @param frame Frame number
+ * @return true if frame is on the interval and not already cached
+ */
+bool KeyframeCache::IsKeyframe(int frame)
+{
+    return frame > 0 && frame % mInterval == 0 && mKeyframes.find(frame) == mKeyframes.end();
+}
+
+/**
+ * Add a keyframe to the cache
+ * @param snapshot Snapshot to add
+ */
+void KeyframeCache::Add(std::shared_ptr<MachineSnapshot> snapshot)
+{
+    auto existing = mKeyframes.find(snapshot->GetFrame());
+    if(existing != mKeyframes.end())
+    {
+        mSize -= existing->second->GetSize();
+    }
+
+    mKeyframes[snapshot->GetFrame()] = snapshot;
+    mSize += snapshot->GetSize();
+
+    Enforce();
+}
+
+/**
+ * Find the nearest keyframe at or before some frame
+ * @param frame Frame number
+ * @return Keyframe snapshot or nullptr if there is none
+ */
+std::shared_ptr<MachineSnapshot> KeyframeCache::Find(int frame)
+{
+    auto keyframe = mKeyframes.upper_bound(frame);
+    if(keyframe == mKeyframes.begin())
+    {
+        return nullptr;
+    }
+
+    return (--keyframe)->second;
+}
+
+/**
+ * Discard all keyframes
+ */
+void KeyframeCache::Clear()
+{
+    mKeyframes.clear();
+    mSize = 0;
+}
+
+/**
+ * Keep the keyframes within the memory budget by doubling
+ * the interval until they fit.
+ */
+void KeyframeCache::Enforce()
+{
+    while(mSize > mBudget && !mKeyframes.empty())
+    {
+        mInterval *= 2;
+        Discard();
+
+        if(mKeyframes.size() == 1 && mSize > mBudget)
+        {
+            // A single keyframe does not fit at all
+            Clear();
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file KeyframeCache.h
+ * @author Max Tetlow
+ *
+ * Cache of machine snapshots taken periodically so
+ * seeking backwards does not have to start over at frame zero.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_KEYFRAMECACHE_H
+#define CANADIANEXPERIENCE_MACHINELIB_KEYFRAMECACHE_H
+
+#include <map>
+#include <memory>
+
+class MachineSnapshot;
+
+/**
+ * Cache of machine snapshots taken periodically so
+ * seeking backwards does not have to start over at frame zero.
+ *
+ * A keyframe is taken every mInterval frames. If the keyframes
+ * exceed the memory budget, the interval is doubled and every
+ * keyframe that is no longer on the interval is discarded.
+ */
+class KeyframeCache
+{
+private:
+    /// Number of frames between keyframes
+    int mInterval = 60;
+
+    /// Maximum memory the keyframes may use in bytes
+    size_t mBudget = 16 * 1024 * 1024;
+
+    /// Memory currently used by the keyframes in bytes
+    size_t mSize = 0;
+
+    /// The keyframes, indexed by frame number
+    std::map<int, std::shared_ptr<MachineSnapshot>> mKeyframes;
+
+    void Discard();
+    void Enforce();
+
+public:
+    KeyframeCache();
+
+    /// Copy constructor (disabled)
+    KeyframeCache(const KeyframeCache &) = delete;
+
+    /// Assignment operator
+    void operator=(const KeyframeCache &) = delete;
+
+    void SetInterval(int interval);
+
+    void SetMemoryBudget(size_t budget);
+
+    bool IsKeyframe(int frame);
+
+    void Add(std::shared_ptr<MachineSnapshot> snapshot);
+
+    std::shared_ptr<MachineSnapshot> Find(int frame);
+
+    void Clear();
+
+    /**
+     * Get the number of frames between keyframes
+     * @return Interval in frames
+     */
+    int GetInterval() {return mInterval;}
+
+    /**
+     * Get the memory currently used by the keyframes
+     * @return Size in bytes
+     */
+    size_t GetSize() {return mSize;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_KEYFRAMECACHE_H
@@ -8,8 +8,19 @@
 #include "ActualMachineSystem.h"
 #include "Component.h"
 #include "BasketballGoal.h"
+#include "MachineSnapshot.h"
+#include "Trace.h"
+#include "DebugDraw.h"
 
+#include <b2_fixture.h>
+#include <b2_circle_shape.h>
+#include <b2_polygon_shape.h>
+#include <b2_edge_shape.h>
+#include <b2_chain_shape.h>
+
+#include <atomic>
 #include <vector>
+#include <algorithm>
 
 /// Gravity in meters per second per second
 const float Gravity = -9.8f;
@@ -20,6 +31,16 @@ const int VelocityIterations = 6;
 /// Number of position update iterations per step
 const int PositionIterations = 2;
 
+/// Color DrawPhysics draws contact points in
+const b2Color ContactColor(1, 1, 0);
+
+/// Color DrawPhysics draws the bounding boxes of region bodies in,
+/// the color Box2D draws them in
+const b2Color BoundsColor(0.9f, 0.3f, 0.9f);
+
+/// Identity for the next physics world any machine builds
+static std::atomic<int> NextWorldId(1);
+
 /**
  * constructor
  * @param number the number that the machine is
@@ -31,14 +52,51 @@ Machine::Machine(int number)
 
 /**
  * Draw the machine
+ *
+ * The frame cache keeps the last frame and draws
+ * again only the parts of it that have changed.
  * @param graphics Graphics device to render onto
  */
 void Machine::Draw(std::shared_ptr<wxGraphicsContext> graphics)
 {
+    MACHINE_TRACE("Machine", "Machine::Draw");
+
+    if(mLayersDirty)
+    {
+        mStaticComponents.clear();
+        mDynamicComponents.clear();
+        for (auto component : mComponents.GetComponents())
+        {
+            if(component->IsStatic())
+            {
+                mStaticComponents.push_back(component);
+            }
+            else
+            {
+                mDynamicComponents.push_back(component);
+            }
+        }
+
+        mFrameCache.Invalidate();
+        mLayersDirty = false;
+    }
+
+    mFrameCache.Draw(graphics, mStaticComponents, mDynamicComponents);
+}
+
+/**
+ * Create the wx objects every component draws with.
+ *
+ * A machine built on a worker thread has none, so this
+ * is called on the main thread before it is first drawn.
+ */
+void Machine::CreateGraphics()
+{
+    MACHINE_TRACE("Machine", "Machine::CreateGraphics");
 
-    for (auto component : mComponents)
+    for(auto component : mComponents.GetComponents())
     {
-        component->Draw(graphics);
+        component->CreateGraphics();
     }
 }
 
@@ -48,8 +106,12 @@ void Machine::Draw(std::shared_ptr<wxGraphicsContext> graphics)
  */
 void Machine::AddComponent(std::shared_ptr<Component> comp)
 {
-    mComponents.push_back(comp);
     comp->SetMachine(this);
+    mComponents.Add(comp);
+    mLayersDirty = true;
+
+    // The new component is not in the physics world yet
+    mInitial = nullptr;
 }
 
 /**
@@ -71,36 +133,496 @@ wxPoint Machine::GetLocation()
 }
 
 /**
- * updates the machine
+ * Advance the machine in time.
+ *
+ * The physics system is always stepped with the fixed PhysicsStep,
+ * as many steps as fit in the machine time. Whatever time is left
+ * over is used to draw moving bodies in between the last two steps.
+ * The physics cost and the trajectories are the same at any frame rate.
+ *
+ * @param elapsed time since the last Advance in seconds
+ */
+void Machine::Advance(double elapsed)
+{
+    mTime += elapsed;
+
+    // Stepping is based on the total time rather than an accumulated
+    // remainder so rounding never moves a step from one frame to another
+    const double Tolerance = 1e-9;
+    while((mSteps + 1) * PhysicsStep <= mTime + Tolerance)
+    {
+        Update(PhysicsStep);
+        mSteps++;
+    }
+
+    auto alpha = (mTime - mSteps * PhysicsStep) / PhysicsStep;
+    alpha = std::clamp(alpha, 0.0, 1.0);
+    for(auto polygon : mInterpolated)
+    {
+        polygon->SetInterpolation(alpha);
+    }
+}
+
+/**
+ * updates the machine one physics step
  * @param elapsed time since the last Update
  */
 void Machine::Update(double elapsed)
 {
+    MACHINE_TRACE("Machine", "Machine::Update");
+
+    for(auto polygon : mInterpolated)
+    {
+        polygon->SavePrevious();
+    }
+
     // Call Update on all of our components so they can advance in time
-    for (auto component : mComponents)
+    mComponents.Update(elapsed);
+
     {
-        component->Update(elapsed);
+        MACHINE_TRACE("Machine", "RotationGraph::Propagate");
+        mRotationGraph.Propagate();
     }
+
     // Advance the physics system one frame in time
-    mWorld->Step(elapsed, VelocityIterations, PositionIterations);
+    auto start = Trace::Now();
+    bool escaped = false;
+    if(mRegions != nullptr)
+    {
+        escaped = !mRegions->Step(elapsed, VelocityIterations, PositionIterations);
+    }
+    else
+    {
+        MACHINE_TRACE("Physics", "b2World::Step");
+        mWorld->Step(elapsed, VelocityIterations, PositionIterations);
+    }
+
+    mPhysicsTime.fetch_add(Trace::Now() - start, std::memory_order_relaxed);
+
+    if(escaped)
+    {
+        MergeRegions();
+    }
+
+    {
+        MACHINE_TRACE("Machine", "ActivityTracker::Update");
+        mActivity.Update(mComponents);
+    }
 }
 
 /**
  * resets the machine, restores everything to value at time zero
+ *
+ * Once the physics world has been built, this restores the state
+ * it was built in without building it again. The replay that
+ * follows is not guaranteed to match the first playback exactly,
+ * see MachineSnapshot::Apply.
  */
 void Machine::Reset()
 {
+    MACHINE_TRACE("Machine", "Machine::Reset");
+
+    // Held here, since restoring can rebuild the world and
+    // replace the initial snapshot while it is being restored
+    auto initial = mInitial;
+    if(initial != nullptr && initial->Restore(this))
+    {
+        return;
+    }
+
+    Rebuild();
+}
+
+/**
+ * Build a new physics world and install every component in it.
+ *
+ * Needed when the components have changed in a way that only
+ * installing them again picks up, like new physics parameters.
+ */
+void Machine::Rebuild()
+{
+    Build(mThreads > 0);
+}
+
+/**
+ * Build new physics worlds and install every component in them
+ * @param regions Split the machine into regions if it can be?
+ */
+void Machine::Build(bool regions)
+{
+    MACHINE_TRACE("Machine", "Machine::Rebuild");
+
+    // Before any world of this machine steps, on any thread
+    PhysicsRegions::InitializeContacts();
+
+    mRegions = nullptr;
     mWorld = std::make_shared<b2World>(b2Vec2(0.0f, Gravity));
+    mWorldId = NextWorldId++;
 
     // Create and install the contact filter
     mContactListener = std::make_shared<ContactListener>();
     mWorld->SetContactListener(mContactListener.get());
 
     //install each component to the physics system
-    for (auto component : mComponents)
+    std::vector<std::vector<b2Body*>> installed;
+    for (auto component : mComponents.GetComponents())
     {
-        component->SetPhysic(mContactListener, mWorld);
+        installed.push_back(PhysicsRegions::Install(component, mContactListener, mWorld));
+    }
+
+    if(regions)
+    {
+        auto split = std::make_unique<PhysicsRegions>(mThreads);
+        if(split->Build(mComponents, mWorld, installed))
+        {
+            mRegions = std::move(split);
+        }
+    }
+
+    // Newest first, the order of the body list of one world
+    mBodies.clear();
+    for(auto bodies = installed.rbegin(); bodies != installed.rend(); bodies++)
+    {
+        mBodies.insert(mBodies.end(), bodies->begin(), bodies->end());
+    }
 
+    mInterpolated.clear();
+    for (auto component : mComponents.GetComponents())
+    {
+        auto polygon = dynamic_cast<cse335::PhysicsPolygon*>(component->GetPolygon());
+        if(polygon != nullptr && polygon->GetBody() != nullptr && polygon->GetType() != b2_staticBody)
+        {
+            polygon->SavePrevious();
+            mInterpolated.push_back(polygon);
+        }
     }
 
+    // The links between components are all made by now
+    mRotationGraph.Compile(mComponents);
+
+    mTime = 0;
+    mSteps = 0;
+    mActivity.Wake(mComponents);
+
+    mInitial = Snapshot();
+}
+
+/**
+ * Go back to stepping the machine in one world, keeping its
+ * state, because a body has left its region.
+ */
+void Machine::MergeRegions()
+{
+    MACHINE_TRACE("Machine", "Machine::MergeRegions");
+
+    // Building replaces the initial snapshot, which
+    // still resets the machine to its regions
+    auto initial = mInitial;
+    auto snapshot = Snapshot();
+    Build(false);
+    snapshot->Apply(this);
+    mInitial = initial;
+}
+
+/**
+ * Set the number of threads to step the machine with.
+ *
+ * With any threads the machine is split into regions that do
+ * not touch when it is built, each stepped in its own physics
+ * world. One thread steps the regions one after another and
+ * gives the same results as any other number of threads. Takes
+ * effect on the next Rebuild, or Reset.
+ * @param threads Number of threads, 0 to step in one world
+ */
+void Machine::SetThreads(int threads)
+{
+    mThreads = std::max(threads, 0);
+
+    // So Reset builds the worlds again
+    mInitial = nullptr;
+}
+
+/**
+ * Get every physics world of the machine
+ * @return The shared world followed by the region worlds
+ */
+std::vector<b2World*> Machine::GetWorlds()
+{
+    std::vector<b2World*> worlds = {mWorld.get()};
+    for(size_t r=0; r<GetRegionCount(); r++)
+    {
+        worlds.push_back(mRegions->GetWorld(r).get());
+    }
+
+    return worlds;
+}
+
+/**
+ * Get the body a body in one of the worlds stands in for
+ * @param body Body in one of the worlds
+ * @return The shared static body if body is a copy of it
+ * in a region, otherwise body itself
+ */
+b2Body* Machine::GetOriginalBody(b2Body* body)
+{
+    return mRegions != nullptr ? mRegions->GetOriginal(body) : body;
+}
+
+/**
+ * Get the body that stands in for a body where it touches another
+ * @param body Body that is touched
+ * @param other Body touching it
+ * @return The body in the same world as other
+ */
+b2Body* Machine::GetContactBody(b2Body* body, b2Body* other)
+{
+    return mRegions != nullptr ? mRegions->GetContactBody(body, other) : body;
+}
+
+/**
+ * Get the contact listener installed in the world a body is in
+ * @param body Body in one of the worlds
+ * @return Contact listener
+ */
+ContactListener* Machine::GetContactListener(b2Body* body)
+{
+    auto listener = mRegions != nullptr ? mRegions->GetContactListener(body) : nullptr;
+    return listener != nullptr ? listener : mContactListener.get();
+}
+
+/**
+ * Get the contact listener of every physics world
+ * @return The listener of the shared world followed
+ * by the listeners of the region worlds
+ */
+std::vector<ContactListener*> Machine::GetContactListeners()
+{
+    std::vector<ContactListener*> listeners = {mContactListener.get()};
+    for(size_t r=0; r<GetRegionCount(); r++)
+    {
+        listeners.push_back(mRegions->GetListener(r).get());
+    }
+
+    return listeners;
+}
+
+/**
+ * Stop suppressing BeginContact and warm starting in every world
+ */
+void Machine::ClearSuppressed()
+{
+    mContactListener->ClearSuppressed();
+    if(mRegions != nullptr)
+    {
+        mRegions->ClearSuppressed();
+    }
+}
+
+/**
+ * Draw the machine as the physics system sees it, on top of
+ * the machine in the same centimeter coordinates.
+ *
+ * Shows the shapes, colored by Box2D by body type and by whether
+ * the body is asleep, the bounding boxes of the fixtures, the
+ * center of every body and where touching bodies make contact.
+ * Everything is batched and stroked once per color.
+ * @param graphics Graphics device to render onto
+ */
+void Machine::DrawPhysics(std::shared_ptr<wxGraphicsContext> graphics)
+{
+    MACHINE_TRACE("Machine", "Machine::DrawPhysics");
+
+    DebugDraw debugDraw(graphics);
+    debugDraw.SetFlags(b2Draw::e_shapeBit | b2Draw::e_jointBit | b2Draw::e_aabbBit | b2Draw::e_centerOfMassBit);
+
+    auto worlds = GetWorlds();
+    for(auto world : worlds)
+    {
+        if(world != worlds.front())
+        {
+            // Region worlds hold copies of the shared static bodies,
+            // which are already drawn with the main world
+            debugDraw.SetFlags(b2Draw::e_jointBit);
+            DrawRegionBodies(debugDraw, world);
+        }
+
+        world->SetDebugDraw(&debugDraw);
+        world->DebugDraw();
+        world->SetDebugDraw(nullptr);
+
+        for(auto contact = world->GetContactList(); contact != nullptr; contact = contact->GetNext())
+        {
+            if(contact->IsTouching())
+            {
+                b2WorldManifold manifold;
+                contact->GetWorldManifold(&manifold);
+                for(int i=0; i<contact->GetManifold()->pointCount; i++)
+                {
+                    debugDraw.DrawPoint(manifold.points[i], 1, ContactColor);
+                }
+            }
+        }
+    }
+
+    debugDraw.Flush();
+}
+
+/**
+ * Draw the bodies of a region world the way b2World::DebugDraw
+ * does, leaving out the copies of shared static bodies
+ * @param debugDraw Where to draw
+ * @param world Region world
+ */
+void Machine::DrawRegionBodies(DebugDraw& debugDraw, b2World* world)
+{
+    for(auto body = world->GetBodyList(); body != nullptr; body = body->GetNext())
+    {
+        if(GetOriginalBody(body) != body)
+        {
+            continue;
+        }
+
+        // The colors b2World::DebugDraw uses
+        b2Color color(0.9f, 0.7f, 0.7f);
+        if(!body->IsEnabled())
+        {
+            color = b2Color(0.5f, 0.5f, 0.3f);
+        }
+        else if(body->GetType() == b2_staticBody)
+        {
+            color = b2Color(0.5f, 0.9f, 0.5f);
+        }
+        else if(body->GetType() == b2_kinematicBody)
+        {
+            color = b2Color(0.5f, 0.5f, 0.9f);
+        }
+        else if(!body->IsAwake())
+        {
+            color = b2Color(0.6f, 0.6f, 0.6f);
+        }
+
+        auto& transform = body->GetTransform();
+        for(auto fixture = body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+        {
+            auto shape = fixture->GetShape();
+            if(shape->GetType() == b2Shape::e_circle)
+            {
+                auto circle = (b2CircleShape*)shape;
+                debugDraw.DrawSolidCircle(b2Mul(transform, circle->m_p), circle->m_radius,
+                                          b2Mul(transform.q, b2Vec2(1, 0)), color);
+            }
+            else if(shape->GetType() == b2Shape::e_polygon)
+            {
+                auto polygon = (b2PolygonShape*)shape;
+                b2Vec2 vertices[b2_maxPolygonVertices];
+                for(int i=0; i<polygon->m_count; i++)
+                {
+                    vertices[i] = b2Mul(transform, polygon->m_vertices[i]);
+                }
+                debugDraw.DrawSolidPolygon(vertices, polygon->m_count, color);
+            }
+            else
+            {
+                for(int child=0; child<shape->GetChildCount(); child++)
+                {
+                    b2EdgeShape edge;
+                    if(shape->GetType() == b2Shape::e_chain)
+                    {
+                        ((b2ChainShape*)shape)->GetChildEdge(&edge, child);
+                    }
+                    else
+                    {
+                        edge = *(b2EdgeShape*)shape;
+                    }
+                    debugDraw.DrawSegment(b2Mul(transform, edge.m_vertex1), b2Mul(transform, edge.m_vertex2), color);
+                }
+            }
+
+            for(int child=0; child<shape->GetChildCount(); child++)
+            {
+                auto& aabb = fixture->GetAABB(child);
+                b2Vec2 corners[4] = {aabb.lowerBound, b2Vec2(aabb.upperBound.x, aabb.lowerBound.y),
+                                     aabb.upperBound, b2Vec2(aabb.lowerBound.x, aabb.upperBound.y)};
+                debugDraw.DrawPolygon(corners, 4, BoundsColor);
+            }
+        }
+
+        b2Transform center = transform;
+        center.p = body->GetWorldCenter();
+        debugDraw.DrawTransform(center);
+    }
+}
+
+/**
+ * Get the number of bodies the physics system is simulating
+ * @return Number of awake bodies
+ */
+size_t Machine::GetAwakeBodyCount()
+{
+    return std::count_if(mBodies.begin(), mBodies.end(), [](b2Body* body) {return body->IsAwake();});
+}
+
+/**
+ * Get the number of contacts in every physics world,
+ * touching or with only their bounding boxes overlapping
+ * @return Number of contacts
+ */
+int Machine::GetContactCount()
+{
+    int count = 0;
+    for(auto world : GetWorlds())
+    {
+        count += world->GetContactCount();
+    }
+
+    return count;
+}
+
+/**
+ * Take a snapshot of the current state of the machine
+ * @param frame The frame the machine is currently on
+ * @return Snapshot that Restore can return the machine to
+ */
+std::shared_ptr<MachineSnapshot> Machine::Snapshot(int frame)
+{
+    return std::make_shared<MachineSnapshot>(this, frame);
+}
+
+/**
+ * Restore the machine to a snapshot.
+ *
+ * If the snapshot was taken in the current physics world, the
+ * bodies and components are rewritten in place. Otherwise the
+ * world is built again first.
+ * @param snapshot Snapshot to restore
+ * @return true if restored, false if the machine does not match
+ * the snapshot and has been left at time zero
+ */
+bool Machine::Restore(const MachineSnapshot& snapshot)
+{
+    return snapshot.Restore(this);
+}
+
+/**
+ * Set the machine time, used when restoring a snapshot.
+ *
+ * The bodies have jumped to where they were at that time,
+ * so they are drawn there rather than interpolated from
+ * where they were before.
+ * @param time Time in seconds since reset
+ * @param steps Physics steps taken since reset
+ */
+void Machine::SetClock(double time, int steps)
+{
+    mTime = time;
+    mSteps = steps;
+
+    // The components have jumped without a physics step
+    mActivity.Wake(mComponents);
+
+    for(auto polygon : mInterpolated)
+    {
+        polygon->SavePrevious();
+        polygon->SetInterpolation(1);
+    }
 }
\ No newline at end of file
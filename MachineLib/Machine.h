@@ -11,9 +11,18 @@
 #include "b2_world.h"
 #include "ContactListener.h"
 #include "PhysicsPolygon.h"
+#include "ComponentStore.h"
+#include "RotationGraph.h"
+#include "FrameCache.h"
+#include "ActivityTracker.h"
+#include "PhysicsRegions.h"
+
+#include <atomic>
 
 class ActualMachineSystem;
 class Component;
+class MachineSnapshot;
+class DebugDraw;
 
 /**
  * class that represents the machine in the machine system
@@ -31,12 +40,70 @@ private:
     /// The machine system the machine is connected to
     ActualMachineSystem* mMachineSystem = nullptr;
 
-    ///Vector that represents the components that make up the hamster
-    std::vector<std::shared_ptr<Component>> mComponents;
+    /// The components that make up the machine
+    ComponentStore mComponents;
+
+    /// Propagates rotation from the hamsters to the sinks,
+    /// declared after the components it refers to
+    RotationGraph mRotationGraph;
 
     ///The number of the machine
     int mMachineNumber = 1;
 
+    /// Components that always look the same, drawn
+    /// once into the cached static layer
+    std::vector<Component*> mStaticComponents;
+
+    /// Components drawn on top of the static layer
+    /// wherever they have changed
+    std::vector<Component*> mDynamicComponents;
+
+    /// Set when the components must be sorted into layers again
+    bool mLayersDirty = true;
+
+    /// The last drawn frame, drawn again only where it changed
+    FrameCache mFrameCache;
+
+    /// Which components are asleep
+    ActivityTracker mActivity;
+
+    /// Nanoseconds spent in physics steps since TakePhysicsTime
+    std::atomic<uint64_t> mPhysicsTime{0};
+
+    /// Machine time in seconds since the last reset
+    double mTime = 0;
+
+    /// Number of physics steps taken since the last reset
+    int mSteps = 0;
+
+    /// Identifies the physics world, different for every
+    /// world any machine builds
+    int mWorldId = 0;
+
+    /// The state right after the physics world was built,
+    /// which Reset restores in place
+    std::shared_ptr<MachineSnapshot> mInitial;
+
+    /// Polygons that move in the physics system and are
+    /// drawn interpolated between physics steps
+    std::vector<cse335::PhysicsPolygon*> mInterpolated;
+
+    /// Every body the components installed, newest first
+    std::vector<b2Body*> mBodies;
+
+    /// Threads to step the machine in regions with, 0 for one world
+    int mThreads = 0;
+
+    /// The regions the machine is stepped in, or
+    /// nullptr when it is stepped in the one world
+    std::unique_ptr<PhysicsRegions> mRegions;
+
+    void Build(bool regions);
+
+    void MergeRegions();
+
+    void DrawRegionBodies(DebugDraw& debugDraw, b2World* world);
+
     //int mFlag;
 
 public:
@@ -48,12 +115,33 @@ public:
 
     void Draw(std::shared_ptr<wxGraphicsContext> graphics);
 
+    void CreateGraphics();
+
     void AddComponent(std::shared_ptr<Component> comp);
 
     void SetSystem(ActualMachineSystem* system);
 
+    /// Fixed time step for the physics system in seconds
+    static constexpr double PhysicsStep = 1.0 / 60.0;
+
     void Update(double elapsed);
 
+    void Advance(double elapsed);
+
+    /**
+     * Get the machine time
+     * @return Time in seconds since the last reset
+     */
+    double GetTime() {return mTime;}
+
+    /**
+     * Get the number of physics steps taken
+     * @return Steps since the last reset
+     */
+    int GetSteps() {return mSteps;}
+
+    void SetClock(double time, int steps);
+
     wxPoint GetLocation();
 
     /**
@@ -70,6 +158,108 @@ public:
 
     void Reset();
 
+    void Rebuild();
+
+    void SetThreads(int threads);
+
+    /**
+     * Get the number of threads the machine is stepped in regions with
+     * @return Threads, 0 if the machine is stepped in one world
+     */
+    int GetThreads() {return mThreads;}
+
+    /**
+     * Get the number of regions the machine is stepped in
+     * @return Number of region worlds, 0 when stepped in one world
+     */
+    size_t GetRegionCount() {return mRegions != nullptr ? mRegions->GetCount() : 0;}
+
+    /**
+     * Get every body the components installed. This is the
+     * order of the world body list when there is one world,
+     * and the same order when the machine is split into regions.
+     * @return Bodies, newest first
+     */
+    const std::vector<b2Body*>& GetBodies() {return mBodies;}
+
+    std::vector<b2World*> GetWorlds();
+
+    b2Body* GetOriginalBody(b2Body* body);
+
+    b2Body* GetContactBody(b2Body* body, b2Body* other);
+
+    ContactListener* GetContactListener(b2Body* body);
+
+    std::vector<ContactListener*> GetContactListeners();
+
+    void ClearSuppressed();
+
+    std::shared_ptr<MachineSnapshot> Snapshot(int frame = 0);
+
+    bool Restore(const MachineSnapshot& snapshot);
+
+    /**
+     * Get the identity of the physics world. Every world
+     * any machine builds gets a different identity.
+     * @return World identity
+     */
+    int GetWorldId() {return mWorldId;}
+
+    /**
+     * Get the physics world for the machine. When the machine is
+     * split into regions this world only has the shared static bodies.
+     * @return Box2D world
+     */
+    std::shared_ptr<b2World> GetWorld() {return mWorld;}
+
+    /**
+     * Get the contact listener installed in the physics world
+     * @return Contact listener
+     */
+    std::shared_ptr<ContactListener> GetContactListener() {return mContactListener;}
+
+    /**
+     * Get the components that make up the machine
+     * @return Vector of components in the order they were added
+     */
+    const std::vector<Component*>& GetComponents() {return mComponents.GetComponents();}
+
+    /**
+     * Get the components that make up the machine grouped by type
+     * @return Component store
+     */
+    const ComponentStore& GetComponentStore() {return mComponents;}
+
+    /**
+     * Get the rotation propagation schedule
+     * @return Rotation graph, compiled by Reset
+     */
+    const RotationGraph& GetRotationGraph() {return mRotationGraph;}
+
+    /**
+     * Get the cache of the last drawn frame
+     * @return Frame cache
+     */
+    const FrameCache& GetFrameCache() {return mFrameCache;}
+
+    /**
+     * Get which components are asleep
+     * @return Activity tracker, updated after every physics step
+     */
+    const ActivityTracker& GetActivity() {return mActivity;}
+
+    /**
+     * Get the time spent in physics steps since the last call
+     * @return Time in nanoseconds
+     */
+    uint64_t TakePhysicsTime() {return mPhysicsTime.exchange(0, std::memory_order_relaxed);}
+
+    size_t GetAwakeBodyCount();
+
+    void DrawPhysics(std::shared_ptr<wxGraphicsContext> graphics);
+
+    int GetContactCount();
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_MACHINE_H
@@ -0,0 +1,742 @@
+/**
+ * @file MachineDescription.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "MachineDescription.h"
+#include "Machine.h"
+#include "Body.h"
+#include "BasketballGoal.h"
+#include "Hamster.h"
+#include "Conveyor.h"
+#include "Pulley.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <wx/file.h>
+#include <wx/mstream.h>
+#include <wx/xml/xml.h>
+
+/// Identifies a compiled machine file
+const char MachineMagic[4] = {'M', 'M', 'C', 'H'};
+
+/// Compiled machine file format version
+const std::uint32_t MachineVersion = 2;
+
+/// Element names of the component types, in Type order
+const wchar_t* TypeNames[] = {L"body", L"hamster", L"conveyor", L"pulley", L"goal"};
+
+/// Header at the start of a compiled machine file
+struct MachineHeader
+{
+    /// MachineMagic
+    char mMagic[4];
+
+    /// MachineVersion
+    std::uint32_t mVersion;
+
+    /// Size of a component record, which changes with the
+    /// compiler and platform the file was compiled with
+    std::uint32_t mRecordSize;
+
+    /// Machine number
+    std::int32_t mMachineNumber;
+
+    /// Number of components
+    std::uint32_t mComponents;
+
+    /// Number of links
+    std::uint32_t mLinks;
+
+    /// Number of points
+    std::uint32_t mPoints;
+
+    /// Number of image names
+    std::uint32_t mImages;
+
+    /// Hash of the XML machine file this was compiled from
+    std::uint64_t mSourceHash;
+};
+
+/**
+ * Read a whole file
+ * @param filename File to read
+ * @param data Set to the contents of the file
+ * @return true if successful
+ */
+static bool ReadFile(const std::wstring& filename, std::vector<char>& data)
+{
+    wxFile file;
+    if(!wxFile::Exists(filename) || !file.Open(filename))
+    {
+        return false;
+    }
+
+    data.resize(file.Length());
+    return file.Read(data.data(), data.size()) == (ssize_t)data.size();
+}
+
+/**
+ * Hash the contents of a machine file
+ * @param data Contents of the file
+ * @return 64 bit FNV-1a hash
+ */
+static std::uint64_t Hash(const std::vector<char>& data)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for(auto c : data)
+    {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/**
+ * Get a numeric attribute of an XML node
+ * @param node Node to read from
+ * @param name Attribute name
+ * @param def Value to use if the attribute is missing
+ * @return Attribute value
+ */
+static double Attribute(wxXmlNode* node, const wxString& name, double def)
+{
+    double value;
+    if(node->GetAttribute(name).ToCDouble(&value))
+    {
+        return value;
+    }
+
+    return def;
+}
+
+/**
+ * Get the position of the shaft of a component
+ * @param component Hamster or conveyor component
+ * @return Shaft position, or the component position for
+ * components that do not have a shaft
+ */
+static wxPoint ShaftPosition(std::shared_ptr<Component> component)
+{
+    if(auto hamster = std::dynamic_pointer_cast<Hamster>(component))
+    {
+        return hamster->GetShaftPosition();
+    }
+
+    if(auto conveyor = std::dynamic_pointer_cast<Conveyor>(component))
+    {
+        return conveyor->GetShaftPosition();
+    }
+
+    return component->GetPosition();
+}
+
+/**
+ * Constructor
+ */
+MachineDescription::MachineDescription()
+{
+}
+
+/**
+ * Load a machine file.
+ *
+ * The file can be either an XML machine file or
+ * a compiled machine file created by Save.
+ * @param filename File to load
+ * @return true if successful
+ */
+bool MachineDescription::Load(const std::wstring& filename)
+{
+    mError.clear();
+
+    std::vector<char> data;
+    if(!ReadFile(filename, data))
+    {
+        mError = L"Unable to read " + filename;
+        return false;
+    }
+
+    mComponents.clear();
+    mLinks.clear();
+    mPoints.clear();
+    mImages.clear();
+
+    bool loaded;
+    if(data.size() >= sizeof(MachineMagic) && memcmp(data.data(), MachineMagic, sizeof(MachineMagic)) == 0)
+    {
+        loaded = LoadBinary(data);
+    }
+    else
+    {
+        loaded = LoadXml(data);
+        mSourceHash = Hash(data);
+    }
+
+    if(!loaded)
+    {
+        mError = filename + L" is not a valid machine file";
+        return false;
+    }
+
+    if(!Validate())
+    {
+        mError = filename + L": " + mError;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Was this description compiled from an XML machine file
+ * as it is now? A compiled file is out of date once the
+ * XML file it was compiled from has been edited.
+ * @param source XML machine file
+ * @return true if the XML file does not exist or is the
+ * one this description was loaded or compiled from
+ */
+bool MachineDescription::IsCompiledFrom(const std::wstring& source)
+{
+    std::vector<char> data;
+    if(!ReadFile(source, data))
+    {
+        return true;
+    }
+
+    return Hash(data) == mSourceHash;
+}
+
+/**
+ * Load an XML machine file
+ * @param data Contents of the file
+ * @return true if successful
+ */
+bool MachineDescription::LoadXml(const std::vector<char>& data)
+{
+    // Prevent error popup from wxWidgets
+    wxLogNull logNo;
+
+    wxMemoryInputStream stream(data.data(), data.size());
+    wxXmlDocument xmlDoc;
+    if(!xmlDoc.Load(stream) || xmlDoc.GetRoot()->GetName() != L"machine")
+    {
+        return false;
+    }
+
+    auto root = xmlDoc.GetRoot();
+    mMachineNumber = (int)Attribute(root, L"number", 1);
+
+    // The id of each component, so links and shafts can refer to them
+    std::vector<std::wstring> ids;
+
+    for(auto node = root->GetChildren(); node != nullptr; node = node->GetNext())
+    {
+        if(node->GetType() != wxXML_ELEMENT_NODE)
+        {
+            continue;
+        }
+
+        auto name = node->GetName();
+        auto ok = name == L"link" || name == L"drive" ? XmlLink(node, ids) : XmlComponent(node, ids);
+        if(!ok)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Load a component from an XML machine file
+ * @param node The component node
+ * @param ids The ids of the components loaded so far, this one is added
+ * @return true if successful
+ */
+bool MachineDescription::XmlComponent(wxXmlNode* node, std::vector<std::wstring>& ids)
+{
+    ComponentRecord record;
+
+    auto name = node->GetName();
+    if(name == L"body")
+    {
+        record.mType = Type::Body;
+    }
+    else if(name == L"hamster")
+    {
+        record.mType = Type::Hamster;
+    }
+    else if(name == L"conveyor")
+    {
+        record.mType = Type::Conveyor;
+    }
+    else if(name == L"pulley")
+    {
+        record.mType = Type::Pulley;
+        record.mSize[0] = Attribute(node, L"radius", 10);
+    }
+    else if(name == L"goal")
+    {
+        record.mType = Type::Goal;
+    }
+    else
+    {
+        return false;
+    }
+
+    record.mX = Attribute(node, L"x", 0);
+    record.mY = Attribute(node, L"y", 0);
+    record.mRotation = Attribute(node, L"rotation", 0);
+    record.mSpeed = Attribute(node, L"speed", 1);
+    record.mRunning = node->GetAttribute(L"running") == L"true";
+    record.mDensity = Attribute(node, L"density", 1.0);
+    record.mFriction = Attribute(node, L"friction", 0.5);
+    record.mRestitution = Attribute(node, L"restitution", 0.5);
+
+    auto type = node->GetAttribute(L"type");
+    record.mBodyType = type == L"dynamic" ? b2_dynamicBody :
+                       type == L"kinematic" ? b2_kinematicBody : b2_staticBody;
+
+    auto image = node->GetAttribute(L"image").ToStdWstring();
+    if(!image.empty())
+    {
+        auto found = std::find(mImages.begin(), mImages.end(), image);
+        record.mImage = int(found - mImages.begin());
+        if(found == mImages.end())
+        {
+            mImages.push_back(image);
+        }
+    }
+
+    wxString shaft;
+    if(node->GetAttribute(L"shaft", &shaft) && !shaft.empty())
+    {
+        auto found = std::find(ids.begin(), ids.end(), shaft.ToStdWstring());
+        if(found == ids.end())
+        {
+            return false;
+        }
+
+        record.mShaft = int(found - ids.begin());
+    }
+
+    record.mFirstPoint = (int)mPoints.size();
+    for(auto child = node->GetChildren(); child != nullptr; child = child->GetNext())
+    {
+        auto shape = child->GetName();
+        if(shape == L"rectangle")
+        {
+            record.mShape = Shape::Rectangle;
+            record.mSize[0] = Attribute(child, L"x", 0);
+            record.mSize[1] = Attribute(child, L"y", 0);
+            record.mSize[2] = Attribute(child, L"width", 0);
+            record.mSize[3] = Attribute(child, L"height", 0);
+        }
+        else if(shape == L"bottom-rectangle")
+        {
+            record.mShape = Shape::BottomCenteredRectangle;
+            record.mSize[2] = Attribute(child, L"width", 0);
+            record.mSize[3] = Attribute(child, L"height", 0);
+        }
+        else if(shape == L"circle")
+        {
+            record.mShape = Shape::Circle;
+            record.mSize[0] = Attribute(child, L"radius", 0);
+        }
+        else if(shape == L"point")
+        {
+            record.mShape = Shape::Points;
+            mPoints.push_back({Attribute(child, L"x", 0), Attribute(child, L"y", 0)});
+            record.mPointCount++;
+        }
+    }
+
+    mComponents.push_back(record);
+    ids.push_back(node->GetAttribute(L"id").ToStdWstring());
+    return true;
+}
+
+/**
+ * Load a link or drive from an XML machine file
+ * @param node The link node
+ * @param ids The ids of the components loaded so far
+ * @return true if successful
+ */
+bool MachineDescription::XmlLink(wxXmlNode* node, const std::vector<std::wstring>& ids)
+{
+    auto sourceId = node->GetAttribute(L"source").ToStdWstring();
+    auto sinkId = node->GetAttribute(L"sink").ToStdWstring();
+    if(sourceId.empty() || sinkId.empty())
+    {
+        return false;
+    }
+
+    auto source = std::find(ids.begin(), ids.end(), sourceId);
+    auto sink = std::find(ids.begin(), ids.end(), sinkId);
+    if(source == ids.end() || sink == ids.end())
+    {
+        return false;
+    }
+
+    LinkRecord link;
+    link.mSource = int(source - ids.begin());
+    link.mSink = int(sink - ids.begin());
+    link.mDrive = node->GetName() == L"drive";
+    mLinks.push_back(link);
+    return true;
+}
+
+/**
+ * Load a compiled machine file
+ * @param data Contents of the file
+ * @return true if successful
+ */
+bool MachineDescription::LoadBinary(const std::vector<char>& data)
+{
+    MachineHeader header;
+    if(data.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+    if(header.mVersion != MachineVersion || header.mRecordSize != sizeof(ComponentRecord))
+    {
+        return false;
+    }
+
+    size_t size = sizeof(header) +
+        header.mComponents * sizeof(ComponentRecord) +
+        header.mLinks * sizeof(LinkRecord) +
+        header.mPoints * sizeof(PointRecord);
+    if(data.size() < size)
+    {
+        return false;
+    }
+
+    mMachineNumber = header.mMachineNumber;
+    mSourceHash = header.mSourceHash;
+
+    auto read = data.data() + sizeof(header);
+    mComponents.resize(header.mComponents);
+    memcpy(mComponents.data(), read, mComponents.size() * sizeof(ComponentRecord));
+    read += mComponents.size() * sizeof(ComponentRecord);
+
+    mLinks.resize(header.mLinks);
+    memcpy(mLinks.data(), read, mLinks.size() * sizeof(LinkRecord));
+    read += mLinks.size() * sizeof(LinkRecord);
+
+    mPoints.resize(header.mPoints);
+    memcpy(mPoints.data(), read, mPoints.size() * sizeof(PointRecord));
+    read += mPoints.size() * sizeof(PointRecord);
+
+    // Image names are a length followed by UTF-8 text
+    auto end = data.data() + data.size();
+    for(std::uint32_t i=0; i<header.mImages; i++)
+    {
+        std::uint32_t length;
+        if(end - read < (ptrdiff_t)sizeof(length))
+        {
+            return false;
+        }
+
+        memcpy(&length, read, sizeof(length));
+        read += sizeof(length);
+        if(end - read < (ptrdiff_t)length)
+        {
+            return false;
+        }
+
+        mImages.push_back(wxString::FromUTF8(read, length).ToStdWstring());
+        read += length;
+    }
+
+    return true;
+}
+
+/**
+ * Save the machine as a compiled machine file.
+ *
+ * Compiled files are only meant to be loaded by a build for
+ * the same platform. Load rejects files from other builds.
+ * @param filename File to write
+ * @return true if successful
+ */
+bool MachineDescription::Save(const std::wstring& filename)
+{
+    wxFile file;
+    if(!file.Create(filename, true))
+    {
+        return false;
+    }
+
+    MachineHeader header;
+    memcpy(header.mMagic, MachineMagic, sizeof(MachineMagic));
+    header.mVersion = MachineVersion;
+    header.mRecordSize = sizeof(ComponentRecord);
+    header.mMachineNumber = mMachineNumber;
+    header.mComponents = (std::uint32_t)mComponents.size();
+    header.mLinks = (std::uint32_t)mLinks.size();
+    header.mPoints = (std::uint32_t)mPoints.size();
+    header.mImages = (std::uint32_t)mImages.size();
+    header.mSourceHash = mSourceHash;
+
+    bool ok = file.Write(&header, sizeof(header)) == sizeof(header);
+    ok = ok && file.Write(mComponents.data(), mComponents.size() * sizeof(ComponentRecord)) == mComponents.size() * sizeof(ComponentRecord);
+    ok = ok && file.Write(mLinks.data(), mLinks.size() * sizeof(LinkRecord)) == mLinks.size() * sizeof(LinkRecord);
+    ok = ok && file.Write(mPoints.data(), mPoints.size() * sizeof(PointRecord)) == mPoints.size() * sizeof(PointRecord);
+
+    for(auto& image : mImages)
+    {
+        auto utf8 = wxString(image).ToUTF8();
+        std::uint32_t length = (std::uint32_t)utf8.length();
+        ok = ok && file.Write(&length, sizeof(length)) == sizeof(length);
+        ok = ok && file.Write(utf8.data(), length) == length;
+    }
+
+    return ok;
+}
+
+/**
+ * Make sure every index in the description refers to something
+ * that exists and every enum value is one Create knows, so Create
+ * never has to check. A compiled file is read without looking
+ * at any of the values, so this is all that checks them.
+ *
+ * Hamsters, conveyors, pulleys and goals are placed on whole
+ * centimeters, so a fractional position for one of them is
+ * rejected rather than rounded into a different machine.
+ * @return true if the description is valid, otherwise
+ * false with mError saying which component is wrong
+ */
+bool MachineDescription::Validate()
+{
+    int count = (int)mComponents.size();
+    for(int i=0; i<count; i++)
+    {
+        auto& record = mComponents[i];
+        auto component = L"component " + std::to_wstring(i + 1);
+        if(record.mType < Type::Body || record.mType > Type::Goal ||
+            record.mShape < Shape::None || record.mShape > Shape::Points ||
+            record.mBodyType < b2_staticBody || record.mBodyType > b2_dynamicBody)
+        {
+            mError = component + L" has an unknown type or shape";
+            return false;
+        }
+
+        component += std::wstring(L" (") + TypeNames[int(record.mType)] + L")";
+        if(record.mImage < -1 || record.mImage >= (int)mImages.size() ||
+            record.mShaft < -1 || record.mShaft >= i ||
+            record.mFirstPoint < 0 || record.mPointCount < 0 ||
+            record.mFirstPoint + record.mPointCount > (int)mPoints.size())
+        {
+            mError = component + L" refers to an image, shaft or point that does not exist";
+            return false;
+        }
+
+        // Only hamsters and conveyors have a shaft
+        if(record.mShaft >= 0 &&
+            mComponents[record.mShaft].mType != Type::Hamster &&
+            mComponents[record.mShaft].mType != Type::Conveyor)
+        {
+            mError = component + L" is placed at the shaft of a component that has none";
+            return false;
+        }
+
+        if(record.mType != Type::Body &&
+            (record.mX != std::round(record.mX) || record.mY != std::round(record.mY)))
+        {
+            mError = component + L" x and y must be whole centimeters";
+            return false;
+        }
+    }
+
+    for(auto& link : mLinks)
+    {
+        if(link.mSource < 0 || link.mSource >= count || link.mSink < 0 || link.mSink >= count)
+        {
+            mError = L"a link refers to a component that does not exist";
+            return false;
+        }
+
+        auto source = mComponents[link.mSource].mType;
+        auto sink = mComponents[link.mSink].mType;
+        if(link.mDrive)
+        {
+            // Only a pulley can drive another pulley
+            if(source != Type::Pulley || sink != Type::Pulley)
+            {
+                mError = L"a drive links components that are not both pulleys";
+                return false;
+            }
+        }
+        else if((source != Type::Hamster && source != Type::Pulley) ||
+                (sink != Type::Body && sink != Type::Pulley && sink != Type::Conveyor))
+        {
+            mError = L"a link has a source or sink that cannot be linked";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Create the machine this describes
+ * @param imagesDir Directory containing the images
+ * @return The created machine
+ */
+std::shared_ptr<Machine> MachineDescription::Create(const std::wstring& imagesDir)
+{
+    auto machine = std::make_shared<Machine>(mMachineNumber);
+
+    std::vector<std::shared_ptr<Component>> components;
+    components.reserve(mComponents.size());
+    for(auto& record : mComponents)
+    {
+        wxPoint2DDouble position(record.mX, record.mY);
+        if(record.mShaft >= 0)
+        {
+            auto shaft = ShaftPosition(components[record.mShaft]);
+            position += wxPoint2DDouble(shaft.x, shaft.y);
+        }
+
+        auto component = CreateComponent(record, position, imagesDir);
+        machine->AddComponent(component);
+        components.push_back(component);
+    }
+
+    for(auto& link : mLinks)
+    {
+        auto source = components[link.mSource];
+        auto sink = components[link.mSink];
+
+        if(link.mDrive)
+        {
+            std::dynamic_pointer_cast<Pulley>(source)->Drive(std::dynamic_pointer_cast<Pulley>(sink));
+            continue;
+        }
+
+        RotationSource* rotation = nullptr;
+        if(auto hamster = std::dynamic_pointer_cast<Hamster>(source))
+        {
+            rotation = hamster->GetSource();
+        }
+        else
+        {
+            rotation = std::dynamic_pointer_cast<Pulley>(source)->GetSource();
+        }
+
+        rotation->AddSink(std::dynamic_pointer_cast<RotationSink>(sink));
+    }
+
+    return machine;
+}
+
+/**
+ * Create one component
+ * @param record The component description
+ * @param position Position of the component in centimeters
+ * @param imagesDir Directory containing the images
+ * @return The created component
+ */
+std::shared_ptr<Component> MachineDescription::CreateComponent(const ComponentRecord& record,
+                                                               wxPoint2DDouble position,
+                                                               const std::wstring& imagesDir)
+{
+    // Whole centimeters, see Validate
+    auto point = wxPoint((int)std::lround(position.m_x), (int)std::lround(position.m_y));
+
+    switch(record.mType)
+    {
+        case Type::Hamster:
+        {
+            auto hamster = std::make_shared<Hamster>(imagesDir);
+            hamster->SetPosition(point.x, point.y);
+            if(record.mRunning)
+            {
+                hamster->SetInitiallyRunning(true);
+            }
+            hamster->SetSpeed(record.mSpeed);
+            return hamster;
+        }
+
+        case Type::Conveyor:
+        {
+            auto conveyor = std::make_shared<Conveyor>(imagesDir);
+            conveyor->SetPosition(point);
+            return conveyor;
+        }
+
+        case Type::Pulley:
+        {
+            auto pulley = std::make_shared<Pulley>(record.mSize[0]);
+            if(record.mImage >= 0)
+            {
+                pulley->GetPolygon()->SetImage(imagesDir + L"/" + mImages[record.mImage]);
+            }
+            pulley->SetPosition(point);
+            return pulley;
+        }
+
+        case Type::Goal:
+        {
+            auto goal = std::make_shared<BasketballGoal>(imagesDir);
+            goal->SetPosition(point.x, point.y);
+            return goal;
+        }
+
+        default:
+            break;
+    }
+
+    auto body = std::make_shared<Body>();
+    auto polygon = body->GetPolygon();
+    switch(record.mShape)
+    {
+        case Shape::Rectangle:
+            polygon->Rectangle(record.mSize[0], record.mSize[1], record.mSize[2], record.mSize[3]);
+            break;
+
+        case Shape::BottomCenteredRectangle:
+            polygon->BottomCenteredRectangle(record.mSize[2], record.mSize[3]);
+            break;
+
+        case Shape::Circle:
+            polygon->Circle(record.mSize[0]);
+            break;
+
+        case Shape::Points:
+            for(int i=0; i<record.mPointCount; i++)
+            {
+                auto& p = mPoints[record.mFirstPoint + i];
+                polygon->AddPoint(p.mX, p.mY);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if(record.mImage >= 0)
+    {
+        polygon->SetImage(imagesDir + L"/" + mImages[record.mImage]);
+    }
+
+    polygon->SetInitialPosition(position.m_x, position.m_y);
+    polygon->SetInitialRotation(record.mRotation);
+    if(record.mBodyType == b2_dynamicBody)
+    {
+        polygon->SetDynamic();
+    }
+    else if(record.mBodyType == b2_kinematicBody)
+    {
+        polygon->SetKinematic();
+    }
+    polygon->SetPhysics(record.mDensity, record.mFriction, record.mRestitution);
+
+    return body;
+}
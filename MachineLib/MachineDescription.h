@@ -0,0 +1,187 @@
+/**
+ * @file MachineDescription.h
+ * @author Max Tetlow
+ *
+ * Declarative description of a machine that is loaded
+ * from a machine file and builds the Machine at runtime.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_MACHINEDESCRIPTION_H
+#define CANADIANEXPERIENCE_MACHINELIB_MACHINEDESCRIPTION_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Machine;
+class Component;
+class wxXmlNode;
+
+/**
+ * Declarative description of a machine.
+ *
+ * A machine is written as an XML machine file listing its
+ * components in drawing order, their geometry, physics and
+ * images, and the rotation source to sink links between them.
+ * Components can be placed relative to the shaft of an
+ * earlier hamster or conveyor.
+ *
+ * The description can also be saved in a compiled binary
+ * form. That is a few flat arrays that load with a single
+ * read, so large machines start without parsing any XML.
+ * The compiled form records a hash of the XML file it was
+ * compiled from, so an out of date one can be detected.
+ */
+class MachineDescription
+{
+public:
+    /// Kinds of component a machine file can contain
+    enum class Type : std::int32_t {Body, Hamster, Conveyor, Pulley, Goal};
+
+    /// Shape of the polygon for a body
+    enum class Shape : std::int32_t {None, Rectangle, BottomCenteredRectangle, Circle, Points};
+
+private:
+    /// One component. Fixed layout, so it can be saved as is.
+    struct ComponentRecord
+    {
+        /// Kind of component
+        Type mType = Type::Body;
+
+        /// Shape of a body polygon
+        Shape mShape = Shape::None;
+
+        /// Physics body type (b2BodyType)
+        std::int32_t mBodyType = 0;
+
+        /// Index of the image name or -1 for no image
+        std::int32_t mImage = -1;
+
+        /// Index of the component whose shaft the position
+        /// is relative to or -1 if the position is absolute
+        std::int32_t mShaft = -1;
+
+        /// Index of the first point of a Points shape
+        std::int32_t mFirstPoint = 0;
+
+        /// Number of points in a Points shape
+        std::int32_t mPointCount = 0;
+
+        /// Is a hamster initially running?
+        std::int32_t mRunning = 0;
+
+        /// Position X in centimeters
+        double mX = 0;
+
+        /// Position Y in centimeters
+        double mY = 0;
+
+        /// Initial rotation in turns
+        double mRotation = 0;
+
+        /// Shape x, y, width, height, or the radius first for a circle
+        double mSize[4] = {0, 0, 0, 0};
+
+        /// Hamster speed
+        double mSpeed = 1;
+
+        /// Body density
+        double mDensity = 1.0;
+
+        /// Body friction
+        double mFriction = 0.5;
+
+        /// Body restitution
+        double mRestitution = 0.5;
+    };
+
+    /// A rotation source to sink link or a pulley drive
+    struct LinkRecord
+    {
+        /// Index of the source component
+        std::int32_t mSource = 0;
+
+        /// Index of the sink component
+        std::int32_t mSink = 0;
+
+        /// Nonzero if this is a pulley driving another pulley
+        std::int32_t mDrive = 0;
+    };
+
+    /// A point of a Points shape
+    struct PointRecord
+    {
+        /// X in centimeters
+        double mX = 0;
+
+        /// Y in centimeters
+        double mY = 0;
+    };
+
+    /// The machine number
+    int mMachineNumber = 1;
+
+    /// The components in drawing order
+    std::vector<ComponentRecord> mComponents;
+
+    /// Links between components
+    std::vector<LinkRecord> mLinks;
+
+    /// Points for all of the Points shapes
+    std::vector<PointRecord> mPoints;
+
+    /// Image filenames relative to the images directory
+    std::vector<std::wstring> mImages;
+
+    /// Hash of the XML machine file the description was loaded from
+    std::uint64_t mSourceHash = 0;
+
+    /// Why the last Load failed, empty if it did not
+    std::wstring mError;
+
+    bool LoadXml(const std::vector<char>& data);
+    bool LoadBinary(const std::vector<char>& data);
+    bool XmlComponent(wxXmlNode* node, std::vector<std::wstring>& ids);
+    bool XmlLink(wxXmlNode* node, const std::vector<std::wstring>& ids);
+    bool Validate();
+    std::shared_ptr<Component> CreateComponent(const ComponentRecord& record, wxPoint2DDouble position,
+                                               const std::wstring& imagesDir);
+
+public:
+    MachineDescription();
+
+    /// Copy constructor (disabled)
+    MachineDescription(const MachineDescription &) = delete;
+
+    /// Assignment operator
+    void operator=(const MachineDescription &) = delete;
+
+    bool Load(const std::wstring& filename);
+
+    bool Save(const std::wstring& filename);
+
+    bool IsCompiledFrom(const std::wstring& source);
+
+    std::shared_ptr<Machine> Create(const std::wstring& imagesDir);
+
+    /**
+     * Get the machine number
+     * @return Machine number
+     */
+    int GetMachineNumber() const {return mMachineNumber;}
+
+    /**
+     * Get why the last Load failed
+     * @return Error message, empty if the load succeeded
+     */
+    const std::wstring& GetError() const {return mError;}
+
+    /**
+     * Get the number of components in the machine
+     * @return Number of components
+     */
+    size_t GetComponentCount() const {return mComponents.size();}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_MACHINEDESCRIPTION_H
@@ -0,0 +1,127 @@
+/**
+ * @file MachineFactory.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "MachineFactory.h"
+#include "Machine.h"
+#include "Machine1Factory.h"
+#include "Machine2Factory.h"
+#include "MachineDescription.h"
+#include "StressMachineFactory.h"
+#include "ImageCache.h"
+
+/// The images directory in resources
+const std::wstring ImagesDirectory = L"/images";
+
+/// The machine files directory in resources. It is inside the
+/// images directory so it is installed wherever the images are.
+const std::wstring MachinesDirectory = ImagesDirectory + L"/machines";
+
+/**
+ * Constructor
+ * @param resourcesDir Path to the resources directory
+ */
+MachineFactory::MachineFactory(std::wstring resourcesDir) : mResourcesDir(resourcesDir)
+{
+}
+
+/**
+ * Pack every image in the images directory into the texture atlas.
+ *
+ * Every machine draws from the same images, so this is done once
+ * at startup, on the main thread, before any machine is created.
+ * Create then only looks the images up. Loading the atlas again
+ * does nothing, and machines created without it load each image
+ * on its own.
+ */
+void MachineFactory::LoadImages()
+{
+    cse335::ImageCache::LoadAtlas(mResourcesDir + ImagesDirectory);
+}
+
+/**
+ * Can this factory create a machine with a number?
+ * @param number Machine number
+ * @return true if Create makes a machine with this number
+ */
+bool MachineFactory::IsAvailable(int number)
+{
+    if(number == 1 || number == 2 || number >= StressMachineFactory::FirstMachineNumber)
+    {
+        return true;
+    }
+
+    auto filename = mResourcesDir + MachinesDirectory + L"/machine" + std::to_wstring(number);
+    return wxFileExists(filename + L".mmc") || wxFileExists(filename + L".xml");
+}
+
+/**
+ * Create a machine.
+ *
+ * The machine is loaded from resources/images/machines/machineN.mmc,
+ * the compiled form, or machineN.xml if there is no compiled file
+ * or it was compiled from an older machineN.xml. Machines 1 and 2
+ * fall back to the built in factories if their file is missing or
+ * cannot be loaded. Any other machine whose file cannot be loaded
+ * is reported with wxLogError and not created.
+ *
+ * Numbers from StressMachineFactory::FirstMachineNumber up are
+ * generated machines with about that many physics bodies.
+ * @param number Machine number. Each number makes a different machine
+ * @return The created machine, reset to time zero, or nullptr if
+ * there is no machine with this number
+ */
+std::shared_ptr<Machine> MachineFactory::Create(int number)
+{
+    std::shared_ptr<Machine> machine;
+
+    if(number >= StressMachineFactory::FirstMachineNumber)
+    {
+        StressMachineFactory stressFactory(mResourcesDir);
+        stressFactory.SetBodyCount(number);
+        machine = stressFactory.Create();
+        machine->SetMachineNumber(number);
+        machine->Reset();
+        return machine;
+    }
+
+    auto filename = mResourcesDir + MachinesDirectory + L"/machine" + std::to_wstring(number);
+    // A compiled file is only used while it matches the XML file
+    MachineDescription description;
+    if((description.Load(filename + L".mmc") && description.IsCompiledFrom(filename + L".xml")) ||
+        description.Load(filename + L".xml"))
+    {
+        machine = description.Create(mResourcesDir + ImagesDirectory);
+        machine->SetMachineNumber(number);
+    }
+    else
+    {
+        if(wxFileExists(filename + L".mmc") || wxFileExists(filename + L".xml"))
+        {
+            wxLogError(L"%s", description.GetError());
+        }
+
+        if(number == 1)
+        {
+            Machine1Factory machine1Factory(mResourcesDir);
+            machine = machine1Factory.Create();
+        }
+        else if(number == 2)
+        {
+            Machine2Factory machine2Factory(mResourcesDir);
+            machine = machine2Factory.Create();
+        }
+        else
+        {
+            wxLogError(L"There is no machine %d", number);
+            return nullptr;
+        }
+
+        machine->SetMachineNumber(number);
+    }
+
+    machine->Reset();
+    return machine;
+}
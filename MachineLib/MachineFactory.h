@@ -0,0 +1,42 @@
+/**
+ * @file MachineFactory.h
+ * @author Max Tetlow
+ *
+ * Factory that creates a machine given its number.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_MACHINEFACTORY_H
+#define CANADIANEXPERIENCE_MACHINELIB_MACHINEFACTORY_H
+
+#include <memory>
+#include <string>
+
+class Machine;
+
+/**
+ * Factory that creates a machine given its number.
+ *
+ * Selects the factory for the machine number so the
+ * machine system and the headless tools build machines
+ * the same way.
+ */
+class MachineFactory
+{
+private:
+    /// Path to the resources directory
+    std::wstring mResourcesDir;
+
+public:
+    MachineFactory(std::wstring resourcesDir);
+
+    /// Default constructor (disabled)
+    MachineFactory() = delete;
+
+    void LoadImages();
+
+    bool IsAvailable(int number);
+
+    std::shared_ptr<Machine> Create(int number);
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_MACHINEFACTORY_H
@@ -0,0 +1,188 @@
+/**
+ * @file MachineSnapshot.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "MachineSnapshot.h"
+#include "Machine.h"
+#include "Component.h"
+
+#include <map>
+#include <b2_body.h>
+#include <b2_contact.h>
+#include <b2_fixture.h>
+#include <b2_world.h>
+
+/**
+ * Constructor, takes a snapshot of the current state of a machine
+ * @param machine Machine to take the snapshot of
+ * @param frame The frame the machine is currently on
+ */
+MachineSnapshot::MachineSnapshot(Machine* machine, int frame) : mFrame(frame)
+{
+    mTime = machine->GetTime();
+    mSteps = machine->GetSteps();
+    mWorldId = machine->GetWorldId();
+
+    // Index of each body in the machine body list, so
+    // contacts can be stored without body pointers
+    std::map<b2Body*, int> indices;
+
+    mBodies.reserve(machine->GetBodies().size());
+    for(auto body : machine->GetBodies())
+    {
+        indices[body] = (int)mBodies.size();
+
+        BodyState state;
+        state.mTransform = body->GetTransform();
+        state.mLinearVelocity = body->GetLinearVelocity();
+        state.mAngularVelocity = body->GetAngularVelocity();
+        state.mGravityScale = body->GetGravityScale();
+        state.mAwake = body->IsAwake();
+        state.mEnabled = body->IsEnabled();
+        mBodies.push_back(state);
+    }
+
+    // A region touches a shared static body through a copy,
+    // which is stored as the body it is a copy of
+    for(auto world : machine->GetWorlds())
+    {
+        for(auto contact = world->GetContactList(); contact != nullptr; contact = contact->GetNext())
+        {
+            if(contact->IsTouching())
+            {
+                ContactState state;
+                state.mBodyA = indices[machine->GetOriginalBody(contact->GetFixtureA()->GetBody())];
+                state.mBodyB = indices[machine->GetOriginalBody(contact->GetFixtureB()->GetBody())];
+                state.mManifold = *contact->GetManifold();
+                mContacts.push_back(state);
+            }
+        }
+    }
+
+    for(auto listener : machine->GetContactListeners())
+    {
+        for(auto& pair : listener->GetSuppressed())
+        {
+            mSuppressed.emplace_back(indices[machine->GetOriginalBody(pair.first)],
+                                     indices[machine->GetOriginalBody(pair.second)]);
+        }
+    }
+
+    for(auto component : machine->GetComponents())
+    {
+        component->SaveState(mComponentState);
+    }
+}
+
+/**
+ * Restore a machine to the state in this snapshot.
+ *
+ * When the machine is still running in the physics world the
+ * snapshot was taken in, the bodies are rewritten in place.
+ * Otherwise the machine is rebuilt first so it has the same
+ * bodies, in the same order, as when the snapshot was taken.
+ *
+ * @param machine Machine to restore
+ * @return true if restored, false if the machine does not match
+ * the snapshot and has been left at time zero
+ */
+bool MachineSnapshot::Restore(Machine* machine) const
+{
+    if(machine->GetWorldId() != mWorldId || machine->GetBodies().size() != mBodies.size())
+    {
+        machine->Rebuild();
+    }
+
+    return Apply(machine);
+}
+
+/**
+ * Write the state in this snapshot into the bodies and
+ * components of a machine, whatever worlds it is built in.
+ *
+ * Every body is taken out of the broad phase while it is moved
+ * and put back after, which drops the contacts of the state the
+ * world was in. The contacts of the snapshot are found again on
+ * the next step and start from the impulses they had.
+ *
+ * Bodies are put back oldest first, the order Machine::Build
+ * creates them in, so the broad phase tree is built the same way.
+ * Box2D reuses freed proxy ids in the order they were freed, so
+ * the ids, and with them the order contacts are created and
+ * solved in, can still differ from a freshly built world. A
+ * chaotic machine can drift from its first playback after a
+ * rewind; MachineRunner --check --rewind measures how far.
+ *
+ * @param machine Machine with the same bodies as the snapshot
+ * @return true if applied, false if the bodies do not match
+ */
+bool MachineSnapshot::Apply(Machine* machine) const
+{
+    auto& bodies = machine->GetBodies();
+    if(bodies.size() != mBodies.size())
+    {
+        return false;
+    }
+
+    for(auto body : bodies)
+    {
+        body->SetEnabled(false);
+    }
+
+    // Machine::GetBodies is newest first
+    for(size_t i=bodies.size(); i-- > 0; )
+    {
+        auto body = bodies[i];
+        auto& state = mBodies[i];
+
+        body->SetTransform(state.mTransform.p, state.mTransform.q.GetAngle());
+        body->SetEnabled(state.mEnabled);
+        body->SetLinearVelocity(state.mLinearVelocity);
+        body->SetAngularVelocity(state.mAngularVelocity);
+        body->SetGravityScale(state.mGravityScale);
+        body->SetAwake(state.mAwake);
+    }
+
+    // Bodies that were already touching have already had
+    // their BeginContact handled, so it must not happen again
+    machine->ClearSuppressed();
+    for(auto& contact : mContacts)
+    {
+        auto bodyA = machine->GetContactBody(bodies[contact.mBodyA], bodies[contact.mBodyB]);
+        auto bodyB = machine->GetContactBody(bodies[contact.mBodyB], bodies[contact.mBodyA]);
+        auto listener = machine->GetContactListener(bodyA);
+        listener->Suppress(bodyA, bodyB);
+        listener->WarmStart(bodyA, bodyB, contact.mManifold);
+    }
+
+    for(auto& pair : mSuppressed)
+    {
+        auto bodyA = machine->GetContactBody(bodies[pair.first], bodies[pair.second]);
+        auto bodyB = machine->GetContactBody(bodies[pair.second], bodies[pair.first]);
+        machine->GetContactListener(bodyA)->Suppress(bodyA, bodyB);
+    }
+
+    auto state = mComponentState.cbegin();
+    for(auto component : machine->GetComponents())
+    {
+        component->RestoreState(state);
+    }
+
+    machine->SetClock(mTime, mSteps);
+    return true;
+}
+
+/**
+ * Get the approximate memory used by this snapshot
+ * @return Size in bytes
+ */
+size_t MachineSnapshot::GetSize()
+{
+    return sizeof(MachineSnapshot) +
+        mBodies.capacity() * sizeof(BodyState) +
+        mContacts.capacity() * sizeof(ContactState) +
+        mSuppressed.capacity() * sizeof(std::pair<int, int>) +
+        mComponentState.capacity() * sizeof(double);
+}
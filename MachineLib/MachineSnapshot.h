@@ -0,0 +1,124 @@
+/**
+ * @file MachineSnapshot.h
+ * @author Max Tetlow
+ *
+ * A full copy of the state of a machine at some frame
+ * that can be restored later.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_MACHINESNAPSHOT_H
+#define CANADIANEXPERIENCE_MACHINELIB_MACHINESNAPSHOT_H
+
+#include <vector>
+#include <utility>
+#include <b2_math.h>
+#include <b2_collision.h>
+
+class Machine;
+
+/**
+ * A full copy of the state of a machine at some frame.
+ *
+ * This records the transform and velocity of every body in the
+ * physics world, which bodies are touching and the contact
+ * impulses between them, and the state each component keeps
+ * outside of the physics system (hamster rotation, conveyor
+ * speed, scoreboard score, etc.)
+ *
+ * A snapshot restores into the physics world it was taken in
+ * without building the world again. Bodies are stored in the
+ * order of Machine::GetBodies, so a snapshot also applies to the
+ * same machine built in other worlds, split into regions or not.
+ */
+class MachineSnapshot
+{
+private:
+    /// The state of a single body in the physics world
+    struct BodyState
+    {
+        /// Position and angle of the body
+        b2Transform mTransform;
+
+        /// Linear velocity in meters per second
+        b2Vec2 mLinearVelocity;
+
+        /// Angular velocity in radians per second
+        float mAngularVelocity = 0;
+
+        /// Gravity scale for the body
+        float mGravityScale = 1;
+
+        /// Is the body awake?
+        bool mAwake = true;
+
+        /// Is the body enabled in the physics world?
+        bool mEnabled = true;
+    };
+
+    /// Two bodies that were touching
+    struct ContactState
+    {
+        /// Index of the body of fixture A
+        int mBodyA = 0;
+
+        /// Index of the body of fixture B
+        int mBodyB = 0;
+
+        /// Contact points and the impulses solved for them
+        b2Manifold mManifold;
+    };
+
+    /// The frame this snapshot was taken at
+    int mFrame = 0;
+
+    /// Machine time in seconds
+    double mTime = 0;
+
+    /// Physics steps the machine had taken
+    int mSteps = 0;
+
+    /// Identity of the physics world the snapshot was taken in
+    int mWorldId = 0;
+
+    /// State of every body, in physics world body list order
+    std::vector<BodyState> mBodies;
+
+    /// The bodies that were touching
+    std::vector<ContactState> mContacts;
+
+    /**
+     * Pairs of bodies, by index, whose BeginContact was still
+     * suppressed by an earlier restore. They were touching when
+     * that snapshot was taken but have not begun again yet.
+     */
+    std::vector<std::pair<int, int>> mSuppressed;
+
+    /// State saved by the components, in component order
+    std::vector<double> mComponentState;
+
+public:
+    MachineSnapshot(Machine* machine, int frame);
+
+    /// Default constructor (disabled)
+    MachineSnapshot() = delete;
+
+    /// Copy constructor (disabled)
+    MachineSnapshot(const MachineSnapshot &) = delete;
+
+    /// Assignment operator
+    void operator=(const MachineSnapshot &) = delete;
+
+    bool Restore(Machine* machine) const;
+
+    bool Apply(Machine* machine) const;
+
+    size_t GetSize();
+
+    /**
+     * Get the frame this snapshot was taken at
+     * @return Frame number
+     */
+    int GetFrame() {return mFrame;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_MACHINESNAPSHOT_H
@@ -0,0 +1,257 @@
+/**
+ * @file ParameterSweep.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "ParameterSweep.h"
+#include "Machine.h"
+#include "MachineFactory.h"
+#include "Body.h"
+#include "Hamster.h"
+#include "BasketballGoal.h"
+
+#include <algorithm>
+#include <future>
+#include <random>
+#include <thread>
+
+/**
+ * Constructor
+ * @param resourcesDir Path to the resources directory
+ */
+ParameterSweep::ParameterSweep(std::wstring resourcesDir) : mResourcesDir(resourcesDir)
+{
+}
+
+/**
+ * Get the parameters for every run of the sweep.
+ *
+ * In grid mode there is one run for every combination of the
+ * values of the parameters. In random mode the values are drawn
+ * from the ranges with the seed, so the runs do not depend on
+ * the number of threads.
+ * @return Parameters for each run
+ */
+std::vector<ParameterSweep::Sample> ParameterSweep::GetSamples() const
+{
+    std::vector<Sample> samples;
+
+    if(mMode == Mode::Random)
+    {
+        std::mt19937 random(mSeed);
+        auto draw = [&random](const Range& range) {
+            std::uniform_real_distribution<double> distribution(range.mMin, range.mMax);
+            return range.mMax > range.mMin ? distribution(random) : range.mMin;
+        };
+
+        for(int run=0; run<mRuns; run++)
+        {
+            Sample sample;
+            sample.mRun = run;
+            sample.mDensity = draw(mDensity);
+            sample.mFriction = draw(mFriction);
+            sample.mRestitution = draw(mRestitution);
+            sample.mSpeed = draw(mSpeed);
+            samples.push_back(sample);
+        }
+
+        return samples;
+    }
+
+    auto value = [](const Range& range, int step) {
+        return range.mSteps > 1 ? range.mMin + (range.mMax - range.mMin) * step / (range.mSteps - 1) : range.mMin;
+    };
+
+    auto steps = [](const Range& range) {return std::max(range.mSteps, 1);};
+
+    for(int d=0; d<steps(mDensity); d++)
+    {
+        for(int f=0; f<steps(mFriction); f++)
+        {
+            for(int r=0; r<steps(mRestitution); r++)
+            {
+                for(int s=0; s<steps(mSpeed); s++)
+                {
+                    Sample sample;
+                    sample.mRun = int(samples.size());
+                    sample.mDensity = value(mDensity, d);
+                    sample.mFriction = value(mFriction, f);
+                    sample.mRestitution = value(mRestitution, r);
+                    sample.mSpeed = value(mSpeed, s);
+                    samples.push_back(sample);
+                }
+            }
+        }
+    }
+
+    return samples;
+}
+
+/**
+ * Run the sweep
+ * @return How each run turned out, in the order of GetSamples,
+ * or nothing if there is no machine with the machine number
+ */
+std::vector<ParameterSweep::Outcome> ParameterSweep::Run()
+{
+    auto samples = GetSamples();
+    std::vector<Outcome> outcomes(samples.size());
+
+    auto threads = mThreads > 0 ? mThreads : int(std::thread::hardware_concurrency());
+    threads = std::clamp(threads, 1, std::max(int(samples.size()), 1));
+
+    // The machines are built here, the workers only step them
+    MachineFactory factory(mResourcesDir);
+    factory.LoadImages();
+
+    std::vector<std::shared_ptr<Machine>> machines;
+    for(int t=0; t<threads; t++)
+    {
+        auto machine = factory.Create(mMachineNumber);
+        if(machine == nullptr)
+        {
+            return {};
+        }
+
+        machines.push_back(machine);
+    }
+
+    // Each worker takes the next run that nobody has taken yet
+    std::atomic<size_t> next(0);
+    std::vector<std::future<void>> workers;
+    for(auto& machine : machines)
+    {
+        workers.push_back(std::async(std::launch::async, [this, &machine, &samples, &outcomes, &next]() {
+            RunSamples(machine.get(), samples, outcomes, next);
+        }));
+    }
+
+    for(auto& worker : workers)
+    {
+        worker.get();
+    }
+
+    return outcomes;
+}
+
+/**
+ * Run samples on one worker thread until there are none left
+ * @param machine Machine for this worker, only this worker uses it
+ * @param samples Parameters for every run
+ * @param outcomes Where to put how each run turned out
+ * @param next Index of the next run nobody has taken
+ */
+void ParameterSweep::RunSamples(Machine* machine, const std::vector<Sample>& samples, std::vector<Outcome>& outcomes,
+                                std::atomic<size_t>& next)
+{
+    auto index = next++;
+    if(index >= samples.size())
+    {
+        return;
+    }
+
+    auto& components = machine->GetComponentStore();
+
+    // The values the machine was built with, which
+    // the multipliers of every run are applied to
+    struct BodyPhysics
+    {
+        double mDensity;
+        double mFriction;
+        double mRestitution;
+    };
+
+    std::vector<BodyPhysics> bodies;
+    for(auto body : components.GetBodies())
+    {
+        auto polygon = body->GetPolygon();
+        bodies.push_back({polygon->GetDensity(), polygon->GetFriction(), polygon->GetRestitution()});
+    }
+
+    std::vector<double> speeds;
+    for(auto hamster : components.GetHamsters())
+    {
+        speeds.push_back(hamster->GetSpeed());
+    }
+
+    for(; index < samples.size(); index = next++)
+    {
+        auto& sample = samples[index];
+
+        for(size_t b=0; b<bodies.size(); b++)
+        {
+            auto& physics = bodies[b];
+            components.GetBodies()[b]->GetPolygon()->SetPhysics(physics.mDensity * sample.mDensity,
+                    std::clamp(physics.mFriction * sample.mFriction, 0.0, 1.0),
+                    std::clamp(physics.mRestitution * sample.mRestitution, 0.0, 1.0));
+        }
+
+        for(size_t h=0; h<speeds.size(); h++)
+        {
+            components.GetHamsters()[h]->SetSpeed(speeds[h] * sample.mSpeed);
+        }
+
+        // Installs the bodies with the new parameters
+        machine->Rebuild();
+
+        Outcome outcome;
+        outcome.mSample = sample;
+
+        auto steps = int(mDuration / Machine::PhysicsStep + 0.5);
+        for(int step=0; step<steps; step++)
+        {
+            machine->Advance(Machine::PhysicsStep);
+
+            if(outcome.mTimeToScore < 0)
+            {
+                for(auto goal : components.GetGoals())
+                {
+                    if(goal->GetScore() > 0)
+                    {
+                        outcome.mTimeToScore = machine->GetTime();
+                        break;
+                    }
+                }
+            }
+        }
+
+        for(auto goal : components.GetGoals())
+        {
+            outcome.mScore += goal->GetScore();
+        }
+
+        for(auto body : machine->GetBodies())
+        {
+            if(body->GetType() == b2_dynamicBody)
+            {
+                outcome.mBodies++;
+                if(!body->IsAwake())
+                {
+                    outcome.mBodiesAtRest++;
+                }
+            }
+        }
+
+        outcomes[index] = outcome;
+    }
+}
+
+/**
+ * Write the outcomes of a sweep as CSV with a header line
+ * @param out Stream to write to
+ * @param outcomes Outcomes to write
+ */
+void ParameterSweep::WriteCsv(std::ostream& out, const std::vector<Outcome>& outcomes)
+{
+    out << "run,density,friction,restitution,speed,score,time_to_score,bodies_at_rest,bodies\n";
+    for(auto& outcome : outcomes)
+    {
+        auto& sample = outcome.mSample;
+        out << sample.mRun << ','
+            << sample.mDensity << ',' << sample.mFriction << ','
+            << sample.mRestitution << ',' << sample.mSpeed << ','
+            << outcome.mScore << ',' << outcome.mTimeToScore << ','
+            << outcome.mBodiesAtRest << ',' << outcome.mBodies << '\n';
+    }
+}
@@ -0,0 +1,205 @@
+/**
+ * @file ParameterSweep.h
+ * @author Max Tetlow
+ *
+ * Runs a machine many times with different physics
+ * parameters and records how each run turned out.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_PARAMETERSWEEP_H
+#define CANADIANEXPERIENCE_MACHINELIB_PARAMETERSWEEP_H
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Machine;
+
+/**
+ * Runs a machine many times with different physics
+ * parameters and records how each run turned out.
+ *
+ * Each parameter is a multiplier on the value every component
+ * was built with: the density, friction and restitution of the
+ * bodies and the speed of the hamsters. The multipliers are
+ * taken either from a grid over their ranges or at random from
+ * them.
+ *
+ * The runs are spread over a pool of worker threads. A machine
+ * is built for each worker on the calling thread, since building
+ * loads images and creates wx objects. Each worker only steps its
+ * own machine, in its own physics world, and reuses it for every
+ * run it takes, so the workers share nothing while the machines
+ * are running.
+ */
+class ParameterSweep
+{
+public:
+    /// How the parameters are chosen
+    enum class Mode {Grid, Random};
+
+    /// Range a parameter is varied over
+    struct Range
+    {
+        /// Smallest multiplier
+        double mMin = 1;
+
+        /// Largest multiplier
+        double mMax = 1;
+
+        /// Number of values in a grid, from mMin to mMax
+        int mSteps = 1;
+    };
+
+    /// The parameters for one run, each a multiplier
+    struct Sample
+    {
+        /// Index of the run
+        int mRun = 0;
+
+        /// Body density multiplier
+        double mDensity = 1;
+
+        /// Body friction multiplier
+        double mFriction = 1;
+
+        /// Body restitution multiplier
+        double mRestitution = 1;
+
+        /// Hamster speed multiplier
+        double mSpeed = 1;
+    };
+
+    /// How one run turned out
+    struct Outcome
+    {
+        /// Parameters the run used
+        Sample mSample;
+
+        /// Total score on the scoreboards at the end of the run
+        int mScore = 0;
+
+        /// Machine time of the first score in seconds, or -1 if nothing scored
+        double mTimeToScore = -1;
+
+        /// Dynamic bodies asleep at the end of the run
+        int mBodiesAtRest = 0;
+
+        /// Dynamic bodies in the machine
+        int mBodies = 0;
+    };
+
+private:
+    /// Path to the resources directory
+    std::wstring mResourcesDir;
+
+    /// The machine to run
+    int mMachineNumber = 1;
+
+    /// Machine time each run lasts in seconds
+    double mDuration = 20;
+
+    /// How the parameters are chosen
+    Mode mMode = Mode::Grid;
+
+    /// Number of runs in random mode
+    int mRuns = 100;
+
+    /// Seed for random mode
+    unsigned mSeed = 1;
+
+    /// Number of worker threads, 0 for one per core
+    int mThreads = 0;
+
+    /// Range of the density multiplier
+    Range mDensity;
+
+    /// Range of the friction multiplier
+    Range mFriction;
+
+    /// Range of the restitution multiplier
+    Range mRestitution;
+
+    /// Range of the hamster speed multiplier
+    Range mSpeed;
+
+public:
+    ParameterSweep(std::wstring resourcesDir);
+
+    /// Default constructor (disabled)
+    ParameterSweep() = delete;
+
+    /// Copy constructor (disabled)
+    ParameterSweep(const ParameterSweep &) = delete;
+
+    /// Assignment operator
+    void operator=(const ParameterSweep &) = delete;
+
+    /**
+     * Set the machine to run
+     * @param machine Machine number
+     */
+    void SetMachineNumber(int machine) {mMachineNumber = machine;}
+
+    /**
+     * Set how long each run lasts
+     * @param duration Machine time in seconds
+     */
+    void SetDuration(double duration) {mDuration = duration;}
+
+    /**
+     * Choose the parameters from a grid over the ranges
+     */
+    void SetGrid() {mMode = Mode::Grid;}
+
+    /**
+     * Choose the parameters at random from the ranges
+     * @param runs Number of runs
+     * @param seed Random seed, the same seed gives the same runs
+     */
+    void SetRandom(int runs, unsigned seed) {mMode = Mode::Random; mRuns = runs; mSeed = seed;}
+
+    /**
+     * Set the number of worker threads
+     * @param threads Number of threads, 0 for one per core
+     */
+    void SetThreads(int threads) {mThreads = threads;}
+
+    /**
+     * Set the range of the body density multiplier
+     * @param range Range to vary over
+     */
+    void SetDensity(const Range& range) {mDensity = range;}
+
+    /**
+     * Set the range of the body friction multiplier
+     * @param range Range to vary over
+     */
+    void SetFriction(const Range& range) {mFriction = range;}
+
+    /**
+     * Set the range of the body restitution multiplier
+     * @param range Range to vary over
+     */
+    void SetRestitution(const Range& range) {mRestitution = range;}
+
+    /**
+     * Set the range of the hamster speed multiplier
+     * @param range Range to vary over
+     */
+    void SetSpeed(const Range& range) {mSpeed = range;}
+
+    std::vector<Sample> GetSamples() const;
+
+    std::vector<Outcome> Run();
+
+    static void WriteCsv(std::ostream& out, const std::vector<Outcome>& outcomes);
+
+private:
+    void RunSamples(Machine* machine, const std::vector<Sample>& samples, std::vector<Outcome>& outcomes,
+                    std::atomic<size_t>& next);
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_PARAMETERSWEEP_H
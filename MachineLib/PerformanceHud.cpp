@@ -0,0 +1,171 @@
+/**
+ * @file PerformanceHud.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "PerformanceHud.h"
+#include "Machine.h"
+#include "ImageCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+/// Width of the panel in pixels
+const double PanelWidth = 260;
+
+/// Height of the graph in pixels
+const int GraphHeight = 80;
+
+/// Width of the bar of one frame in pixels
+const int BarWidth = 2;
+
+/// Height of the text under the graph in pixels
+const double TextHeight = 48;
+
+/// Space around the graph and text in pixels
+const double Padding = 6;
+
+/// Frame time at the top of the graph in milliseconds
+const double GraphMilliseconds = 33.3;
+
+/// Frame time budget line in milliseconds, 60 frames per second
+const double BudgetMilliseconds = 16.7;
+
+/// Nanoseconds per millisecond
+const double NanosecondsPerMillisecond = 1e6;
+
+/// Red, green and blue of the update, physics and draw parts of a bar
+const unsigned char PhaseColors[3][3] = {{80, 160, 255}, {255, 170, 40}, {100, 220, 100}};
+
+/**
+ * Constructor
+ */
+PerformanceHud::PerformanceHud() : mGraph(Frames * BarWidth, GraphHeight)
+{
+    mGraph.InitAlpha();
+    std::memset(mGraph.GetAlpha(), 0, size_t(mGraph.GetWidth()) * mGraph.GetHeight());
+}
+
+/**
+ * Scroll the graph left by one bar and add the bar of a frame
+ * at the right, stacked update, physics, draw from the bottom
+ * @param sample Times of the frame
+ */
+void PerformanceHud::AddSample(const Sample& sample)
+{
+    auto width = mGraph.GetWidth();
+    auto rgb = mGraph.GetData();
+    auto alpha = mGraph.GetAlpha();
+    auto scale = GraphHeight / GraphMilliseconds;
+
+    // Tops of the three parts, in pixels up from the bottom
+    double tops[3];
+    tops[0] = sample.mUpdate * scale;
+    tops[1] = tops[0] + sample.mPhysics * scale;
+    tops[2] = tops[1] + sample.mDraw * scale;
+
+    for(int row=0; row<GraphHeight; row++)
+    {
+        auto line = rgb + size_t(row) * width * 3;
+        auto lineAlpha = alpha + size_t(row) * width;
+        std::memmove(line, line + BarWidth * 3, (width - BarWidth) * 3);
+        std::memmove(lineAlpha, lineAlpha + BarWidth, width - BarWidth);
+
+        // Which part of the bar this row is in, 3 for above the bar
+        auto up = GraphHeight - row - 0.5;
+        int phase = 0;
+        while(phase < 3 && up >= tops[phase])
+        {
+            phase++;
+        }
+
+        for(int x=width - BarWidth; x<width; x++)
+        {
+            if(phase < 3)
+            {
+                std::memcpy(line + x * 3, PhaseColors[phase], 3);
+            }
+            lineAlpha[x] = phase < 3 ? 255 : 0;
+        }
+    }
+
+    mGraphDirty = true;
+}
+
+/**
+ * Take the times of the frame just drawn and draw the overlay.
+ *
+ * Drawn in pixels with the top left of the panel at (0, 0)
+ * of whatever transform graphics has.
+ * @param graphics Graphics context to draw on
+ * @param machine Machine the frame is of
+ */
+void PerformanceHud::Draw(std::shared_ptr<wxGraphicsContext> graphics, Machine* machine)
+{
+    Sample sample;
+    auto physics = machine->TakePhysicsTime();
+    auto update = mUpdateTime.exchange(0, std::memory_order_relaxed);
+    sample.mPhysics = float(physics / NanosecondsPerMillisecond);
+    sample.mUpdate = float((update > physics ? update - physics : 0) / NanosecondsPerMillisecond);
+    sample.mDraw = float(mDrawTime.exchange(0, std::memory_order_relaxed) / NanosecondsPerMillisecond);
+    AddSample(sample);
+
+    auto graphTop = Padding;
+    auto graphBottom = Padding + GraphHeight;
+
+    if(mRenderer != graphics->GetRenderer())
+    {
+        mRenderer = graphics->GetRenderer();
+
+        mPanel = graphics->CreatePath();
+        mPanel.AddRoundedRectangle(0, 0, PanelWidth, GraphHeight + TextHeight + Padding * 3, 4);
+
+        mFont = graphics->CreateFont(wxFont(wxFontInfo(9).Family(wxFONTFAMILY_TELETYPE)), *wxWHITE);
+        mGraphDirty = true;
+    }
+
+    if(mGraphDirty)
+    {
+        mGraphBitmap = graphics->CreateBitmapFromImage(mGraph);
+        mGraphDirty = false;
+    }
+
+    graphics->PushState();
+
+    graphics->SetPen(*wxTRANSPARENT_PEN);
+    graphics->SetBrush(wxBrush(wxColour(0, 0, 0, 160)));
+    graphics->FillPath(mPanel);
+
+    // One bar per frame, oldest on the left
+    graphics->DrawBitmap(mGraphBitmap, Padding, graphTop, Frames * BarWidth, GraphHeight);
+
+    auto scale = GraphHeight / GraphMilliseconds;
+    auto budget = graphBottom - BudgetMilliseconds * scale;
+    graphics->SetPen(wxPen(wxColour(255, 80, 80), 1));
+    graphics->StrokeLine(Padding, budget, Padding + Frames * BarWidth, budget);
+
+    std::wstringstream counts;
+    counts << std::fixed << std::setprecision(1)
+           << L"update " << sample.mUpdate << L" physics " << sample.mPhysics
+           << L" draw " << sample.mDraw << L" ms";
+
+    std::wstringstream bodies;
+    bodies << L"bodies " << machine->GetBodies().size()
+           << L" awake " << machine->GetAwakeBodyCount()
+           << L" contacts " << machine->GetContactCount();
+
+    std::wstringstream images;
+    images << std::fixed << std::setprecision(1)
+           << L"image cache hits " << cse335::ImageCache::GetHitRate() * 100 << L"%";
+
+    graphics->SetFont(mFont);
+    auto y = graphBottom + Padding;
+    graphics->DrawText(counts.str(), Padding, y);
+    graphics->DrawText(bodies.str(), Padding, y + TextHeight / 3);
+    graphics->DrawText(images.str(), Padding, y + TextHeight * 2 / 3);
+
+    graphics->PopState();
+}
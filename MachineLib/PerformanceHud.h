@@ -0,0 +1,101 @@
+/**
+ * @file PerformanceHud.h
+ * @author Max Tetlow
+ *
+ * Overlay that shows where the time of each frame goes.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_PERFORMANCEHUD_H
+#define CANADIANEXPERIENCE_MACHINELIB_PERFORMANCEHUD_H
+
+#include <atomic>
+#include <memory>
+
+class Machine;
+
+/**
+ * Overlay that shows where the time of each frame goes.
+ *
+ * Shows a rolling graph of the last frames, each a bar split into
+ * the time spent updating the machine, stepping the physics and
+ * drawing, with the body, awake body and contact counts and the
+ * image cache hit rate.
+ *
+ * The times are added to atomic counters, so recording them takes
+ * no lock, and taken out once a frame when the overlay is drawn.
+ * The panel is a path and the font a graphics font created once
+ * per renderer. The graph is kept in an image that scrolls left
+ * by one bar when a sample is added, with only the new bar written
+ * into it, and is drawn as one bitmap.
+ */
+class PerformanceHud
+{
+private:
+    /// Number of frames in the graph
+    static const int Frames = 120;
+
+    /// Times of one frame in milliseconds
+    struct Sample
+    {
+        /// Updating the machine, not counting physics
+        float mUpdate = 0;
+
+        /// Stepping the physics
+        float mPhysics = 0;
+
+        /// Drawing the machine
+        float mDraw = 0;
+    };
+
+    /// The graph of the last frames, oldest on the left,
+    /// transparent where there is no bar
+    wxImage mGraph;
+
+    /// The graph as a bitmap
+    wxGraphicsBitmap mGraphBitmap;
+
+    /// Has a sample been added since mGraphBitmap was created?
+    bool mGraphDirty = true;
+
+    /// Nanoseconds spent updating since the last frame was drawn
+    std::atomic<uint64_t> mUpdateTime{0};
+
+    /// Nanoseconds spent drawing the last frame
+    std::atomic<uint64_t> mDrawTime{0};
+
+    /// The renderer mPanel and mFont were created with
+    wxGraphicsRenderer* mRenderer = nullptr;
+
+    /// The panel background
+    wxGraphicsPath mPanel;
+
+    /// Font for the counts
+    wxGraphicsFont mFont;
+
+    void AddSample(const Sample& sample);
+
+public:
+    PerformanceHud();
+
+    /// Copy constructor (disabled)
+    PerformanceHud(const PerformanceHud &) = delete;
+
+    /// Assignment operator
+    void operator=(const PerformanceHud &) = delete;
+
+    /**
+     * Add time spent updating the machine
+     * @param nanoseconds Time in nanoseconds
+     */
+    void AddUpdateTime(uint64_t nanoseconds) {mUpdateTime.fetch_add(nanoseconds, std::memory_order_relaxed);}
+
+    /**
+     * Add time spent drawing the machine
+     * @param nanoseconds Time in nanoseconds
+     */
+    void AddDrawTime(uint64_t nanoseconds) {mDrawTime.fetch_add(nanoseconds, std::memory_order_relaxed);}
+
+    void Draw(std::shared_ptr<wxGraphicsContext> graphics, Machine* machine);
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_PERFORMANCEHUD_H
@@ -9,6 +9,7 @@
 #include <b2_polygon_shape.h>
 #include <b2_circle_shape.h>
 #include <b2_fixture.h>
+#include <b2_contact.h>
 #include <b2_world.h>
 
 /**
@@ -24,10 +25,104 @@ cse335::PhysicsPolygon::PhysicsPolygon() : Polygon()
  */
 void cse335::PhysicsPolygon::Draw(std::shared_ptr<wxGraphicsContext> graphics)
 {
-    auto position = GetPosition();
-    auto rotation = GetRotation();
+    wxPoint2DDouble position;
+    double rotation;
+    GetDrawPose(position, rotation);
 
     DrawPolygon(graphics, position.m_x, position.m_y, rotation);
+
+    mDrawnPosition = position;
+    mDrawnRotation = rotation;
+    mDrawn = true;
+}
+
+/**
+ * Get where Draw draws the polygon
+ * @param position Set to the position in centimeters
+ * @param rotation Set to the rotation in turns
+ */
+void cse335::PhysicsPolygon::GetDrawPose(wxPoint2DDouble& position, double& rotation)
+{
+    position = GetPosition();
+    rotation = GetRotation();
+
+    if(mBody != nullptr && mAlpha < 1)
+    {
+        // Draw in between the last two physics steps
+        auto previous = wxPoint2DDouble(mPreviousPosition.x * Consts::MtoCM, mPreviousPosition.y * Consts::MtoCM);
+        position = previous + (position - previous) * mAlpha;
+
+        auto previousRotation = mPreviousAngle / (M_PI * 2);
+        rotation = previousRotation + (rotation - previousRotation) * mAlpha;
+    }
+}
+
+/**
+ * Get the rectangle Draw covers
+ * @return Bounding rectangle in centimeters
+ */
+wxRect2DDouble cse335::PhysicsPolygon::GetBounds()
+{
+    wxPoint2DDouble position;
+    double rotation;
+    GetDrawPose(position, rotation);
+
+    return Polygon::GetBounds(position.m_x, position.m_y, rotation);
+}
+
+/**
+ * Has the polygon moved since it was last drawn?
+ * @return true if Draw would draw it somewhere else
+ */
+bool cse335::PhysicsPolygon::HasMoved()
+{
+    wxPoint2DDouble position;
+    double rotation;
+    GetDrawPose(position, rotation);
+
+    return !mDrawn || position != mDrawnPosition || rotation != mDrawnRotation;
+}
+
+/**
+ * Is the body at rest, along with every body touching it?
+ *
+ * Static bodies are never awake, so a static body is at rest
+ * as long as nothing awake is touching it.
+ * @return true if the body is not in the physics system or
+ * nothing on or touching it is awake
+ */
+bool cse335::PhysicsPolygon::IsResting()
+{
+    if(mBody == nullptr)
+    {
+        return true;
+    }
+
+    if(mBody->IsAwake())
+    {
+        return false;
+    }
+
+    for(auto edge = mBody->GetContactList(); edge != nullptr; edge = edge->next)
+    {
+        if(edge->contact->IsTouching() && edge->other->IsAwake())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Save the current body state as the previous state
+ * before a physics step.
+ */
+void cse335::PhysicsPolygon::SavePrevious()
+{
+    mPreviousPosition = mBody->GetPosition();
+    mPreviousAngle = mBody->GetAngle();
+    mAlpha = 1;
 }
 
 /**
@@ -12,6 +12,11 @@
  * 1.00 Initial version for FS23 project 2
  * 1.01 Revised to work prior to physics installation
  * 1.02 Disabled the ability to use DrawPolygon directly
+ * 1.03 Added GetType
+ * 1.04 Draws interpolated between the last two physics steps
+ * 1.05 Added GetDensity, GetFriction and GetRestitution
+ * 1.06 Added GetDrawPose, GetBounds and HasMoved
+ * 1.07 Added IsResting
  */
 
 #pragma once
@@ -63,6 +68,25 @@ private:
     /// Restitution (elasticity) in the range [0, 1]
     double mRestitution = 0.5;
 
+    /// Body position before the last physics step in meters
+    b2Vec2 mPreviousPosition = b2Vec2(0, 0);
+
+    /// Body angle before the last physics step in radians
+    float mPreviousAngle = 0;
+
+    /// How far we are from the previous to the current
+    /// physics state when drawing, 1 draws the current state
+    double mAlpha = 1;
+
+    /// Position the polygon was last drawn at
+    wxPoint2DDouble mDrawnPosition;
+
+    /// Rotation the polygon was last drawn at
+    double mDrawnRotation = 0;
+
+    /// Has the polygon been drawn?
+    bool mDrawn = false;
+
 public:
     PhysicsPolygon();
 
@@ -74,6 +98,14 @@ public:
 
     virtual void Draw(std::shared_ptr<wxGraphicsContext> graphics);
 
+    void GetDrawPose(wxPoint2DDouble& position, double& rotation);
+
+    wxRect2DDouble GetBounds();
+
+    bool HasMoved();
+
+    bool IsResting();
+
     /**
      * Set the component position in the machine
      * @param x X position in centimeters
@@ -101,6 +133,39 @@ public:
     void SetKinematic();
     void SetPhysics(double density=1.0, double friction=0.5, double restitution=0.5);
 
+    void SavePrevious();
+
+    /**
+     * Set how far between the previous and current physics
+     * state to draw this polygon
+     * @param alpha 0 for the previous state, 1 for the current state
+     */
+    void SetInterpolation(double alpha) {mAlpha = alpha;}
+
+    /**
+     * Get the body type this polygon is installed with
+     * @return b2_staticBody, b2_kinematicBody or b2_dynamicBody
+     */
+    b2BodyType GetType() {return mType;}
+
+    /**
+     * Get the density the body is installed with
+     * @return Density in kg/m^2
+     */
+    double GetDensity() {return mDensity;}
+
+    /**
+     * Get the friction the body is installed with
+     * @return Friction coefficient
+     */
+    double GetFriction() {return mFriction;}
+
+    /**
+     * Get the restitution the body is installed with
+     * @return Restitution
+     */
+    double GetRestitution() {return mRestitution;}
+
     /**
      * Get the physics body for this component.
      *
@@ -0,0 +1,480 @@
+/**
+ * @file PhysicsRegions.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "PhysicsRegions.h"
+#include "ComponentStore.h"
+#include "Component.h"
+#include "ContactListener.h"
+#include "Body.h"
+#include "Consts.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <b2_body.h>
+#include <b2_fixture.h>
+#include <b2_polygon_shape.h>
+#include <b2_world.h>
+
+/**
+ * Constructor
+ * @param threads Number of threads that step the regions,
+ * 1 steps them one after another on the calling thread
+ */
+PhysicsRegions::PhysicsRegions(int threads) : mThreads(std::max(threads, 1))
+{
+}
+
+/**
+ * Destructor, ends the worker threads
+ */
+PhysicsRegions::~PhysicsRegions()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mWake.notify_all();
+    for(auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * Make Box2D set up its contact types before any world steps.
+ *
+ * Box2D 2.4.1 fills in its table of contact functions the first
+ * time any world creates a contact, guarded by a plain static flag.
+ * Worlds stepped on several threads at once, region worlds or the
+ * machines of a parameter sweep, would race to fill it in. This
+ * steps a throwaway world with two overlapping boxes once, so the
+ * table is filled in before any machine is stepped. Safe to call
+ * from any thread, any number of times.
+ */
+void PhysicsRegions::InitializeContacts()
+{
+    static std::once_flag initialized;
+    std::call_once(initialized, []() {
+        b2World world(b2Vec2(0, 0));
+
+        b2PolygonShape box;
+        box.SetAsBox(1, 1);
+
+        b2BodyDef ground;
+        world.CreateBody(&ground)->CreateFixture(&box, 0);
+
+        b2BodyDef dynamic;
+        dynamic.type = b2_dynamicBody;
+        world.CreateBody(&dynamic)->CreateFixture(&box, 1);
+
+        world.Step(0.01f, 1, 1);
+    });
+}
+
+/**
+ * Install a component in a physics world
+ * @param component Component to install
+ * @param listener Contact listener installed in the world
+ * @param world Physics world
+ * @return The bodies the component created, newest first
+ */
+std::vector<b2Body*> PhysicsRegions::Install(Component* component, std::shared_ptr<ContactListener> listener,
+                                             std::shared_ptr<b2World> world)
+{
+    auto previous = world->GetBodyList();
+    component->SetPhysic(listener, world);
+
+    // Bodies are added to the front of the world body list
+    std::vector<b2Body*> bodies;
+    for(auto body = world->GetBodyList(); body != previous; body = body->GetNext())
+    {
+        bodies.push_back(body);
+    }
+
+    return bodies;
+}
+
+/**
+ * Split a machine that has been installed in one physics world into regions.
+ *
+ * Components that are not static bodies are grouped by their bounds,
+ * and each group is installed again in a world of its own. Their
+ * bodies in the shared world are destroyed, which leaves only the
+ * static bodies there, and those are copied into the regions they
+ * overlap.
+ * @param components The components of the machine
+ * @param shared The world every component has been installed in
+ * @param installed The bodies each component created, in component
+ * order, updated for the components installed again
+ * @return true if the machine was split, false if it does not split
+ * into more than one region and has been left as it was
+ */
+bool PhysicsRegions::Build(const ComponentStore& components, std::shared_ptr<b2World> shared,
+                           std::vector<std::vector<b2Body*>>& installed)
+{
+    MACHINE_TRACE("Machine", "PhysicsRegions::Build");
+
+    auto& all = components.GetComponents();
+
+    // The components to group and their bounds, with margin
+    std::vector<size_t> members;
+    std::vector<b2AABB> bounds;
+    for(size_t i=0; i<all.size(); i++)
+    {
+        auto body = dynamic_cast<Body*>(all[i]);
+        if(installed[i].empty() || (body != nullptr && body->IsStatic()))
+        {
+            continue;
+        }
+
+        auto rect = all[i]->GetBounds();
+        if(rect.IsEmpty())
+        {
+            // No way to know what the component could touch
+            return false;
+        }
+
+        b2AABB box;
+        box.lowerBound.Set(float((rect.GetLeft() - Margin / 2) / Consts::MtoCM),
+                           float((rect.GetTop() - Margin / 2) / Consts::MtoCM));
+        box.upperBound.Set(float((rect.GetRight() + Margin / 2) / Consts::MtoCM),
+                           float((rect.GetBottom() + Margin / 2) / Consts::MtoCM));
+
+        members.push_back(i);
+        bounds.push_back(box);
+    }
+
+    std::vector<size_t> parent(members.size());
+    std::iota(parent.begin(), parent.end(), 0);
+
+    std::function<size_t(size_t)> find = [&parent, &find](size_t m) {
+        return parent[m] == m ? m : parent[m] = find(parent[m]);
+    };
+
+    // Group overlapping components, sweeping across in x
+    std::vector<size_t> order(members.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&bounds](size_t a, size_t b) {
+        return bounds[a].lowerBound.x < bounds[b].lowerBound.x;
+    });
+
+    std::vector<size_t> active;
+    for(auto m : order)
+    {
+        auto& box = bounds[m];
+        active.erase(std::remove_if(active.begin(), active.end(), [&bounds, &box](size_t a) {
+            return bounds[a].upperBound.x < box.lowerBound.x;
+        }), active.end());
+
+        for(auto a : active)
+        {
+            if(b2TestOverlap(bounds[a], box))
+            {
+                parent[find(a)] = find(m);
+            }
+        }
+
+        active.push_back(m);
+    }
+
+    // A group's bounds can overlap another group even where none
+    // of their components do, so merge until no group bounds overlap
+    std::vector<size_t> roots;
+    std::map<size_t, b2AABB> groups;
+    for(bool merged = true; merged; )
+    {
+        merged = false;
+        groups.clear();
+        for(size_t m=0; m<members.size(); m++)
+        {
+            auto root = find(m);
+            auto group = groups.find(root);
+            if(group == groups.end())
+            {
+                groups[root] = bounds[m];
+            }
+            else
+            {
+                group->second.Combine(bounds[m]);
+            }
+        }
+
+        roots.clear();
+        for(auto& group : groups)
+        {
+            roots.push_back(group.first);
+        }
+
+        for(size_t a=0; a<roots.size() && !merged; a++)
+        {
+            for(size_t b=a+1; b<roots.size() && !merged; b++)
+            {
+                if(b2TestOverlap(groups[roots[a]], groups[roots[b]]))
+                {
+                    parent[find(roots[a])] = find(roots[b]);
+                    merged = true;
+                }
+            }
+        }
+    }
+
+    if(groups.size() < 2)
+    {
+        return false;
+    }
+
+    // Regions are ordered by their first component, so the
+    // split does not depend on anything but the machine
+    std::map<size_t, size_t> regionOf;
+    for(size_t m=0; m<members.size(); m++)
+    {
+        auto root = find(m);
+        if(regionOf.find(root) == regionOf.end())
+        {
+            regionOf[root] = mRegions.size();
+
+            Region region;
+            region.mWorld = std::make_shared<b2World>(shared->GetGravity());
+            region.mListener = std::make_shared<ContactListener>();
+            region.mWorld->SetContactListener(region.mListener.get());
+            region.mBounds = groups[root];
+            mRegions.push_back(region);
+        }
+    }
+
+    for(size_t m=0; m<members.size(); m++)
+    {
+        auto i = members[m];
+        auto& region = mRegions[regionOf[find(m)]];
+
+        for(auto body : installed[i])
+        {
+            shared->DestroyBody(body);
+        }
+
+        installed[i] = Install(all[i], region.mListener, region.mWorld);
+    }
+
+    // Copy what is left in the shared world, the static bodies,
+    // into every region they overlap
+    for(auto body = shared->GetBodyList(); body != nullptr; body = body->GetNext())
+    {
+        for(auto& region : mRegions)
+        {
+            bool overlaps = false;
+            for(auto fixture = body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            {
+                overlaps = overlaps || b2TestOverlap(fixture->GetAABB(0), region.mBounds);
+            }
+
+            if(!overlaps)
+            {
+                continue;
+            }
+
+            b2BodyDef definition;
+            definition.type = body->GetType();
+            definition.position = body->GetPosition();
+            definition.angle = body->GetAngle();
+            auto copy = region.mWorld->CreateBody(&definition);
+
+            for(auto fixture = body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            {
+                b2FixtureDef fixtureDef;
+                fixtureDef.shape = fixture->GetShape();
+                fixtureDef.density = fixture->GetDensity();
+                fixtureDef.friction = fixture->GetFriction();
+                fixtureDef.restitution = fixture->GetRestitution();
+                fixtureDef.isSensor = fixture->IsSensor();
+                fixtureDef.filter = fixture->GetFilterData();
+                copy->CreateFixture(&fixtureDef);
+            }
+
+            mCopies[std::make_pair(body, region.mWorld.get())] = copy;
+            mOriginals[copy] = body;
+        }
+    }
+
+    auto workers = std::min(mThreads, int(mRegions.size())) - 1;
+    for(int w=0; w<workers; w++)
+    {
+        mWorkers.emplace_back(&PhysicsRegions::Work, this);
+    }
+
+    return true;
+}
+
+/**
+ * Step every region world
+ * @param elapsed Time to step in seconds
+ * @param velocityIterations Velocity iterations per step
+ * @param positionIterations Position iterations per step
+ * @return true if every body is still inside its region,
+ * false if the regions could now touch
+ */
+bool PhysicsRegions::Step(double elapsed, int velocityIterations, int positionIterations)
+{
+    mElapsed = float(elapsed);
+    mVelocityIterations = velocityIterations;
+    mPositionIterations = positionIterations;
+    mNext = 0;
+
+    if(mWorkers.empty())
+    {
+        StepRegions();
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mBusy = int(mWorkers.size());
+            mGeneration++;
+        }
+
+        mWake.notify_all();
+        StepRegions();
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]() {return mBusy == 0;});
+    }
+
+    for(auto& region : mRegions)
+    {
+        if(region.mEscaped)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Worker thread, steps regions every time it is woken
+ */
+void PhysicsRegions::Work()
+{
+    uint64_t generation = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait(lock, [this, generation]() {return mStop || mGeneration != generation;});
+            if(mStop)
+            {
+                return;
+            }
+
+            generation = mGeneration;
+        }
+
+        StepRegions();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(--mBusy == 0)
+        {
+            mDone.notify_one();
+        }
+    }
+}
+
+/**
+ * Step regions until there are none left that nobody has taken
+ */
+void PhysicsRegions::StepRegions()
+{
+    for(auto index = mNext++; index < mRegions.size(); index = mNext++)
+    {
+        StepRegion(mRegions[index]);
+    }
+}
+
+/**
+ * Step one region world and check its bodies are still inside it
+ * @param region Region to step
+ */
+void PhysicsRegions::StepRegion(Region& region)
+{
+    MACHINE_TRACE("Physics", "b2World::Step");
+
+    region.mWorld->Step(mElapsed, mVelocityIterations, mPositionIterations);
+
+    region.mEscaped = false;
+    for(auto body = region.mWorld->GetBodyList(); body != nullptr && !region.mEscaped; body = body->GetNext())
+    {
+        if(body->GetType() == b2_staticBody || !body->IsAwake())
+        {
+            continue;
+        }
+
+        for(auto fixture = body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+        {
+            if(!region.mBounds.Contains(fixture->GetAABB(0)))
+            {
+                region.mEscaped = true;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Stop suppressing BeginContact and warm starting in every region
+ */
+void PhysicsRegions::ClearSuppressed()
+{
+    for(auto& region : mRegions)
+    {
+        region.mListener->ClearSuppressed();
+    }
+}
+
+/**
+ * Get the body that stands in for a body where it touches another.
+ *
+ * A shared static body is touched through its copy in the world of
+ * the other body. Any other body stands for itself.
+ * @param body Body that is touched
+ * @param other Body touching it
+ * @return The body in the same world as other
+ */
+b2Body* PhysicsRegions::GetContactBody(b2Body* body, b2Body* other)
+{
+    auto copy = mCopies.find(std::make_pair(body, other->GetWorld()));
+    return copy != mCopies.end() ? copy->second : body;
+}
+
+/**
+ * Get the shared static body a body is a copy of
+ * @param body Body in one of the worlds
+ * @return The shared body, or body itself if it is not a copy
+ */
+b2Body* PhysicsRegions::GetOriginal(b2Body* body)
+{
+    auto original = mOriginals.find(body);
+    return original != mOriginals.end() ? original->second : body;
+}
+
+/**
+ * Get the contact listener for the world a body is in
+ * @param body Body in one of the region worlds
+ * @return Contact listener or nullptr if the body is not in a region
+ */
+ContactListener* PhysicsRegions::GetContactListener(b2Body* body)
+{
+    for(auto& region : mRegions)
+    {
+        if(region.mWorld.get() == body->GetWorld())
+        {
+            return region.mListener.get();
+        }
+    }
+
+    return nullptr;
+}
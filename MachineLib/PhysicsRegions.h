@@ -0,0 +1,174 @@
+/**
+ * @file PhysicsRegions.h
+ * @author Max Tetlow
+ *
+ * A machine split into physics worlds that do not touch,
+ * stepped in parallel.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_PHYSICSREGIONS_H
+#define CANADIANEXPERIENCE_MACHINELIB_PHYSICSREGIONS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <b2_collision.h>
+
+class b2Body;
+class b2World;
+class Component;
+class ComponentStore;
+class ContactListener;
+
+/**
+ * A machine split into physics worlds that do not touch,
+ * stepped in parallel.
+ *
+ * The components are grouped by their bounds when the machine is
+ * built. Components closer than Margin end up in the same region,
+ * and every region gets a physics world of its own. Static bodies
+ * with no contact behavior, like floors and shelves, stay in the
+ * shared world of the machine and a copy is put into each region
+ * they overlap.
+ *
+ * Each step every region world is stepped on its own, on a pool of
+ * worker threads. A region is only ever stepped by one thread at a
+ * time, and the contact callbacks of its components only change
+ * those components, so the results do not depend on the number of
+ * threads or the order the regions finish in.
+ *
+ * After a step, a body that has left the bounds of its region could
+ * touch another region. Step then returns false and the machine must
+ * go back to a single world.
+ */
+class PhysicsRegions
+{
+private:
+    /// One physics world and the space its bodies must stay in
+    struct Region
+    {
+        /// The physics world
+        std::shared_ptr<b2World> mWorld;
+
+        /// The contact listener installed in the world
+        std::shared_ptr<ContactListener> mListener;
+
+        /// Space the bodies must stay in, in meters
+        b2AABB mBounds;
+
+        /// Did a body leave the bounds in the last step?
+        bool mEscaped = false;
+    };
+
+    /// The regions, ordered by their first component
+    std::vector<Region> mRegions;
+
+    /// The copy of each shared static body in each region world it overlaps
+    std::map<std::pair<b2Body*, b2World*>, b2Body*> mCopies;
+
+    /// The shared static body each copy was made from
+    std::map<b2Body*, b2Body*> mOriginals;
+
+    /// Number of threads that step the regions
+    int mThreads = 1;
+
+    /// Worker threads, the calling thread makes one more
+    std::vector<std::thread> mWorkers;
+
+    /// Protects the worker state below
+    std::mutex mMutex;
+
+    /// Wakes the workers for a step
+    std::condition_variable mWake;
+
+    /// Wakes the calling thread when the workers are done
+    std::condition_variable mDone;
+
+    /// Counts the steps the workers have been woken for
+    uint64_t mGeneration = 0;
+
+    /// Number of workers still stepping
+    int mBusy = 0;
+
+    /// Set to end the workers
+    bool mStop = false;
+
+    /// Index of the next region nobody has taken
+    std::atomic<size_t> mNext{0};
+
+    /// Time to step in seconds
+    float mElapsed = 0;
+
+    /// Velocity iterations per step
+    int mVelocityIterations = 0;
+
+    /// Position iterations per step
+    int mPositionIterations = 0;
+
+    void Work();
+
+    void StepRegions();
+
+    void StepRegion(Region& region);
+
+public:
+    /// Space kept around the components of a region, in centimeters
+    static constexpr double Margin = 40;
+
+    PhysicsRegions(int threads);
+
+    ~PhysicsRegions();
+
+    /// Default constructor (disabled)
+    PhysicsRegions() = delete;
+
+    /// Copy constructor (disabled)
+    PhysicsRegions(const PhysicsRegions &) = delete;
+
+    /// Assignment operator
+    void operator=(const PhysicsRegions &) = delete;
+
+    bool Build(const ComponentStore& components, std::shared_ptr<b2World> shared,
+               std::vector<std::vector<b2Body*>>& installed);
+
+    bool Step(double elapsed, int velocityIterations, int positionIterations);
+
+    void ClearSuppressed();
+
+    b2Body* GetContactBody(b2Body* body, b2Body* other);
+
+    b2Body* GetOriginal(b2Body* body);
+
+    ContactListener* GetContactListener(b2Body* body);
+
+    /**
+     * Get the number of regions
+     * @return Number of region worlds
+     */
+    size_t GetCount() const {return mRegions.size();}
+
+    /**
+     * Get the physics world of a region
+     * @param region Region index
+     * @return Physics world
+     */
+    std::shared_ptr<b2World> GetWorld(size_t region) const {return mRegions[region].mWorld;}
+
+    /**
+     * Get the contact listener of a region
+     * @param region Region index
+     * @return Contact listener installed in the region world
+     */
+    std::shared_ptr<ContactListener> GetListener(size_t region) const {return mRegions[region].mListener;}
+
+    static std::vector<b2Body*> Install(Component* component, std::shared_ptr<ContactListener> listener,
+                                        std::shared_ptr<b2World> world);
+
+    static void InitializeContacts();
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_PHYSICSREGIONS_H
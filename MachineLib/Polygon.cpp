@@ -6,17 +6,20 @@
 
 #include "pch.h"
 
+#include <algorithm>
 #include <sstream>
 #include <wx/hyperlink.h>
+#include <wx/thread.h>
 
 #include "Polygon.h"
+#include "Trace.h"
 
 using namespace cse335;
 
 /**
  * Constructor
  */
-Polygon::Polygon() : mBrush(*wxBLACK)
+Polygon::Polygon()
 {
 }
 
@@ -34,16 +37,98 @@ Polygon::~Polygon()
  */
 void Polygon::AddPoint(double x, double y)
 {
-    if(mHasDrawn)
+    if(mHasDrawn || mShape != nullptr)
     {
-        // Our polygon MUST have at least three points
+        // The points are shared once the polygon has been used
         Assert(false,
-                L"You cannot add points to the polygon after it has been drawn.",
+                L"You cannot add points to the polygon after it has been drawn or used.",
                 L"https://facweb.cse.msu.edu/cbowen/cse335/polygon/o/");
         return;
     }
 
-    mPoints.push_back(wxPoint2DDouble(x, y));
+    if(mPendingPoints == nullptr)
+    {
+        mPendingPoints = std::make_unique<std::vector<wxPoint2DDouble>>();
+    }
+
+    mPendingPoints->push_back(wxPoint2DDouble(x, y));
+}
+
+/**
+ * Get the shape of the polygon, sharing the points added so far
+ * with every other polygon that has the same points. No more
+ * points can be added after.
+ * @return Shape or nullptr if there are no points
+ */
+const std::shared_ptr<PolygonShape>& Polygon::GetShape()
+{
+    if(mShape == nullptr && mPendingPoints != nullptr)
+    {
+        mShape = ShapeCache::Intern(*mPendingPoints);
+        mPendingPoints = nullptr;
+    }
+
+    return mShape;
+}
+
+/**
+ * Get the points that make up the polygon
+ * @return Points, empty if there are none
+ */
+const std::vector<wxPoint2DDouble>& Polygon::GetPoints()
+{
+    /// Points of a polygon that has none
+    static const std::vector<wxPoint2DDouble> NoPoints;
+
+    auto& shape = GetShape();
+    return shape != nullptr ? shape->GetPoints() : NoPoints;
+}
+
+/**
+ * Get the data for drawing an image
+ * @return Image data or nullptr if no image has been set
+ */
+Polygon::ImageData* Polygon::GetImageData()
+{
+    auto data = std::get_if<std::unique_ptr<ImageData>>(&mMode);
+    return data != nullptr ? data->get() : nullptr;
+}
+
+/**
+ * Get the image set for the polygon
+ * @return Image or nullptr if no image has been set
+ */
+CachedImage* Polygon::GetImage()
+{
+    auto data = GetImageData();
+    return data != nullptr ? data->mImage.get() : nullptr;
+}
+
+/**
+ * Get the brush the polygon is filled with
+ * @return Brush or nullptr if the polygon is not in color
+ * mode or its brush has not been created yet
+ */
+wxBrush* Polygon::GetBrush()
+{
+    if(auto brush = std::get_if<wxBrush>(&mMode))
+    {
+        return brush;
+    }
+
+    auto data = GetImageData();
+    return data != nullptr ? std::get_if<wxBrush>(&data->mColor) : nullptr;
+}
+
+/**
+ * Has a color been set that has no brush yet?
+ * @return true if CreateGraphics has a brush to create
+ */
+bool Polygon::IsColorPending()
+{
+    auto data = GetImageData();
+    return std::holds_alternative<PendingColor>(mMode) ||
+        (data != nullptr && std::holds_alternative<PendingColor>(data->mColor));
 }
 
 
@@ -61,28 +146,29 @@ void Polygon::AddPoint(double x, double y)
  */
 void Polygon::Rectangle(double x, double y, double width, double height)
 {
+    auto image = GetImage();
     if(width <= 0)
     {
         // Optional automatic width determination from image
-        if(!Assert(mImage != nullptr,
+        if(!Assert(image != nullptr,
                    L"You must select an image before calling Rectangle with no specified width."))
         {
             return;
         }
 
-        width = mImage->GetWidth();
+        width = image->GetWidth();
     }
 
     if(height <= 0)
     {
         // Optional automatic height determination from image
-        if(!Assert(mImage != nullptr,
+        if(!Assert(image != nullptr,
                L"You must select an image before calling Rectangle with no specified height."))
         {
             return;
         }
 
-        height = (int)(width * mImage->GetHeight() / mImage->GetWidth());
+        height = (int)(width * image->GetHeight() / image->GetWidth());
     }
 
     if(mInvertedY)
@@ -114,7 +200,7 @@ void Polygon::BottomCenteredRectangle(double width, double height)
 {
     if(width == 0)
     {
-        if(!Assert(mImage != nullptr,
+        if(!Assert(GetImage() != nullptr,
                 L"You must select an image before calling BottomCenteredRectangle with no width."))
         {
             return;
@@ -124,7 +210,7 @@ void Polygon::BottomCenteredRectangle(double width, double height)
     }
     else if(height == 0)
     {
-        if(!Assert(mImage != nullptr,
+        if(!Assert(GetImage() != nullptr,
                 L"You must select an image before calling BottomCenteredRectangle with no height."))
         {
             return;
@@ -145,13 +231,13 @@ void Polygon::CenteredSquare(double size)
 {
     if(size == 0)
     {
-        if(!Assert(mImage != nullptr,
+        if(!Assert(GetImage() != nullptr,
                 L"You must select an image before calling BottomCenteredRectangle."))
         {
             return;
         }
 
-        size = mImage->GetWidth();
+        size = GetImage()->GetWidth();
     }
 
     if(mInvertedY)
@@ -175,6 +261,13 @@ void Polygon::Circle(double radius, int steps)
 {
     mIsCircle = true;
 
+    if(mPendingPoints == nullptr && mShape == nullptr && steps > 0)
+    {
+        // Every ball of the same size shares one circle
+        mShape = ShapeCache::Circle(radius, steps);
+        return;
+    }
+
     for (int i = 0; i < steps; i++)
     {
         double angle = double(i) / double(steps) * M_PI * 2;
@@ -185,12 +278,25 @@ void Polygon::Circle(double radius, int steps)
 
 /**
  * Set the color of the polygon. If we set a color, images are not used.
+ *
+ * Only the color values are kept, the brush is created
+ * by CreateGraphics, so this can be called on any thread.
+ * An image set before is kept, so its size is still known.
  * @param color A Gdiplus Color object.
  */
-void Polygon::SetColor(wxColour color)
+void Polygon::SetColor(const wxColour& color)
 {
-    mBrush.SetColour(color);
-    mMode = Mode::Color;
+    PendingColor pending{color.Red(), color.Green(), color.Blue(), color.Alpha()};
+
+    auto data = GetImageData();
+    if(data != nullptr)
+    {
+        data->mColor = pending;
+    }
+    else
+    {
+        mMode = pending;
+    }
 }
 
 /**
@@ -199,25 +305,84 @@ void Polygon::SetColor(wxColour color)
  */
 void Polygon::SetImage(std::wstring filename)
 {
-    // Prevent error popup from wxWidgets
-    wxLogNull logNo;
-
-    mImage = std::make_unique<wxImage>();
-    if(mImage->LoadFile(filename, wxBITMAP_TYPE_ANY))
+    auto image = ImageCache::Load(filename);
+    if(image != nullptr)
     {
-        mMode = Mode::Image;
+        auto data = std::make_unique<ImageData>();
+        data->mImage = image;
+        mMode = std::move(data);
     }
     else
     {
+        if(auto data = GetImageData())
+        {
+            // No image to draw any more, only a color set after it
+            auto color = data->mColor;
+            std::visit([this](auto& mode) {mMode = mode;}, color);
+        }
+
         std::wstringstream str;
         str << L"Unable to load '" << filename << "'" << std::endl;
-        wxMessageBox(str.str(), L"Polygon Image File Load Failure!");
-        mImage = nullptr;
+
+        if(wxThread::IsMain())
+        {
+            wxMessageBox(str.str(), L"Polygon Image File Load Failure!");
+        }
+        else if(wxTheApp != nullptr)
+        {
+            // Machines may be built on a worker thread, where
+            // no dialog box can be displayed
+            auto message = str.str();
+            wxTheApp->CallAfter([message]() {
+                wxMessageBox(message, L"Polygon Image File Load Failure!");
+            });
+        }
     }
 }
 
 
 
+/**
+ * Create the wx objects the polygon draws with.
+ *
+ * A polygon is built from plain data, so it can be built on
+ * any thread. The brush of a color, the wxImage of an image and
+ * the clip region of the shape are created here instead, on the
+ * thread that draws. Called by DrawPolygon for anything not yet
+ * created, so calling it first only moves the work out of the
+ * first draw.
+ */
+void Polygon::CreateGraphics()
+{
+    auto data = GetImageData();
+    if(auto color = std::get_if<PendingColor>(&mMode))
+    {
+        wxBrush brush(wxColour(color->mRed, color->mGreen, color->mBlue, color->mAlpha));
+        mMode = brush;
+    }
+    else if(data != nullptr && std::holds_alternative<PendingColor>(data->mColor))
+    {
+        auto& color = std::get<PendingColor>(data->mColor);
+        wxBrush brush(wxColour(color.mRed, color.mGreen, color.mBlue, color.mAlpha));
+        data->mColor = brush;
+    }
+
+    auto image = GetImage();
+    if(image != nullptr && GetBrush() == nullptr && GetShape() != nullptr)
+    {
+        if(image->GetAtlas() != nullptr)
+        {
+            image->GetAtlas()->GetImage();
+        }
+        else
+        {
+            image->GetImage();
+        }
+
+        mShape->GetClipRegion();
+    }
+}
+
 /**
  * Draw the polygon
  * @param graphics Graphics object to draw on
@@ -227,7 +392,7 @@ void Polygon::SetImage(std::wstring filename)
  */
 void Polygon::DrawPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double rotation)
 {
-    if(mPoints.size() < 3)
+    if(GetPoints().size() < 3)
     {
         // Our polygon MUST have at least three points
         Assert(false,
@@ -238,6 +403,11 @@ void Polygon::DrawPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x,
 
     mHasDrawn = true;
 
+    if(IsColorPending())
+    {
+        CreateGraphics();
+    }
+
 #ifndef WIN32
     if(mOpacity < 1)
     {
@@ -246,22 +416,21 @@ void Polygon::DrawPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x,
     }
 #endif
 
-    switch (mMode) {
-    case Mode::Color:
+    if(GetBrush() != nullptr)
+    {
         DrawColorPolygon(graphics, x, y, rotation);
-        break;
-
-    case Mode::Image:
+    }
+    else if(GetImageData() != nullptr)
+    {
         DrawImagePolygon(graphics, x, y, rotation);
-        break;
-
-    default:
+    }
+    else
+    {
         // If this assertion fails, the no color or image was
         // indicated for this polygon. Be sure to call
         Assert(false,
                 L"You must specify either a color or an image when using Polygon",
                 L"https://facweb.cse.msu.edu/cbowen/cse335/polygon/c/");
-        break;
     }
 
 #ifndef WIN32
@@ -275,34 +444,63 @@ void Polygon::DrawPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x,
 
 
 /**
- * Draw the polygon as a solid color-filled polygon
- * @param graphics Graphics object to draw on
+ * Get the rectangle the polygon covers when it is drawn
  * @param x X location to draw in pixels
  * @param y Y location to draw in pixels
- * @param rotation Rotation in turns
+ * @param rotation Rotation in turns (0-1)
+ * @return Bounding rectangle, empty if there is no shape
  */
-void Polygon::DrawColorPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double rotation)
+wxRect2DDouble Polygon::GetBounds(double x, double y, double rotation)
 {
-    if(mPath.IsNull())
+    auto& points = GetPoints();
+    if(points.empty())
     {
-        // Create the graphics path
-        mPath = graphics->CreatePath();
+        return wxRect2DDouble();
+    }
+
+    auto sine = sin(rotation * M_PI * 2);
+    auto cosine = cos(rotation * M_PI * 2);
 
-        mPath.MoveToPoint(mPoints[0].m_x, mPoints[0].m_y);
-        for(size_t i=1; i<mPoints.size(); i++)
+    wxPoint2DDouble topLeft(x, y);
+    wxPoint2DDouble bottomRight(x, y);
+    for(size_t i=0; i<points.size(); i++)
+    {
+        auto& point = points[i];
+        wxPoint2DDouble p(x + point.m_x * cosine - point.m_y * sine,
+                          y + point.m_x * sine + point.m_y * cosine);
+        if(i == 0)
         {
-            mPath.AddLineToPoint(mPoints[i].m_x, mPoints[i].m_y);
+            topLeft = bottomRight = p;
         }
-        mPath.CloseSubpath();
+
+        topLeft.m_x = std::min(topLeft.m_x, p.m_x);
+        topLeft.m_y = std::min(topLeft.m_y, p.m_y);
+        bottomRight.m_x = std::max(bottomRight.m_x, p.m_x);
+        bottomRight.m_y = std::max(bottomRight.m_y, p.m_y);
     }
 
+    return wxRect2DDouble(topLeft.m_x, topLeft.m_y,
+                          bottomRight.m_x - topLeft.m_x, bottomRight.m_y - topLeft.m_y);
+}
+
+/**
+ * Draw the polygon as a solid color-filled polygon
+ * @param graphics Graphics object to draw on
+ * @param x X location to draw in pixels
+ * @param y Y location to draw in pixels
+ * @param rotation Rotation in turns
+ */
+void Polygon::DrawColorPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double rotation)
+{
+    auto& path = mShape->GetPath(graphics);
+
     graphics->PushState();
 
     graphics->Translate(x, y);
     graphics->Rotate(rotation * M_PI * 2);
 
-    graphics->SetBrush(mBrush);
-    graphics->FillPath(mPath);
+    graphics->SetBrush(*GetBrush());
+    graphics->FillPath(path);
 
     graphics->PopState();
 }
@@ -320,92 +518,87 @@ void Polygon::DrawColorPolygon(std::shared_ptr<wxGraphicsContext> graphics, doub
  */
 void Polygon::DrawImagePolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double rotation)
 {
-    if(mBitmapDirty || mGraphicsBitmap.IsNull())
+    auto& data = *GetImageData();
+    auto& image = data.mImage;
+    if(data.mBitmapDirty || data.mGraphicsBitmap.IsNull())
     {
+        MACHINE_TRACE("Polygon", "Polygon::CreateBitmap");
+
 #ifdef WIN32
         // Implementation of opacity for Windows systems.
         // Windows does not support transparency layers.
         if(mOpacity < 1) {
+            // The image is shared, so work on a copy
+            wxImage img = image->GetImage().Copy();
+
             // Ensure the image has an alpha map
-            if (!mImage->HasAlpha()) {
-                mImage->InitAlpha();
+            if (!img.HasAlpha()) {
+                img.InitAlpha();
             }
 
-            wxImage img = mImage->Copy();
-
             unsigned char *alpha = img.GetAlpha();
             for(int i=0; i<img.GetWidth()*img.GetHeight(); i++)
             {
                 alpha[i] = int(alpha[i] * mOpacity);
             }
 
-            mGraphicsBitmap = graphics->CreateBitmapFromImage(img);
+            data.mGraphicsBitmap = graphics->CreateBitmapFromImage(img);
+            data.mFromAtlas = false;
         }
         else
         {
-            mGraphicsBitmap = graphics->CreateBitmapFromImage(*mImage);
+            data.mFromAtlas = image->GetAtlas() != nullptr;
+            data.mGraphicsBitmap = data.mFromAtlas ? image->GetAtlas()->GetBitmap(graphics) : image->GetBitmap(graphics);
         }
 #else
-        mGraphicsBitmap = graphics->CreateBitmapFromImage(*mImage);
+        data.mFromAtlas = image->GetAtlas() != nullptr;
+        data.mGraphicsBitmap = data.mFromAtlas ? image->GetAtlas()->GetBitmap(graphics) : image->GetBitmap(graphics);
 #endif
 
-        //
-        // Determine the top left and the size of the
-        // region covered by our polygon
-        //
-        mImageClipRegionTopLeft = mPoints[0];
-        auto imageClipRegionBottomRight = mPoints[0];
-
-        for(auto point : mPoints)
-        {
-            if(point.m_x < mImageClipRegionTopLeft.m_x) {
-                mImageClipRegionTopLeft.m_x = point.m_x;
-            }
-
-            if(point.m_y < mImageClipRegionTopLeft.m_y) {
-                mImageClipRegionTopLeft.m_y = point.m_y;
-            }
-
-            if(point.m_x > imageClipRegionBottomRight.m_x) {
-                imageClipRegionBottomRight.m_x = point.m_x;
-            }
-
-            if(point.m_y > imageClipRegionBottomRight.m_y) {
-                imageClipRegionBottomRight.m_y = point.m_y;
-            }
-        }
-
-        mImageClipRegionSize = imageClipRegionBottomRight - mImageClipRegionTopLeft;
-
-        mImageClipRegion.Clear();
-        std::vector<wxPoint> points;
-        for(auto point : mPoints)
-        {
-            points.push_back(wxPoint(int(point.m_x - mImageClipRegionTopLeft.m_x + 0.5),
-                    int(point.m_y - mImageClipRegionTopLeft.m_y + 0.5)));
-        }
-
-        mImageClipRegion = wxRegion(points.size(), &points[0]);
-        mBitmapDirty = false;
+        data.mBitmapDirty = false;
     }
 
+    // The region covered by our polygon, shared
+    // with every polygon of the same shape
+    auto& box = mShape->GetBox();
+
     graphics->PushState();
 
     graphics->Translate(x, y);
     graphics->Rotate(rotation * M_PI * 2);
 
-    graphics->Translate(mImageClipRegionTopLeft.m_x, mImageClipRegionTopLeft.m_y);
-    graphics->Clip(mImageClipRegion);
+    graphics->Translate(box.m_x, box.m_y);
+    graphics->Clip(mShape->GetClipRegion());
+
+    // The part of the bitmap that is our image. When drawing
+    // from an atlas, the whole page is scaled and offset so
+    // our part of it lands on the clip region. The clip
+    // keeps the rest of the page from being drawn.
+    double left = 0;
+    double top = 0;
+    double width = box.m_width;
+    double height = box.m_height;
+    if(data.mFromAtlas)
+    {
+        auto& rect = image->GetAtlasRect();
+        auto& atlas = image->GetAtlas();
+        double sx = box.m_width / rect.width;
+        double sy = box.m_height / rect.height;
+        left = -rect.x * sx;
+        top = -rect.y * sy;
+        width = atlas->GetWidth() * sx;
+        height = atlas->GetHeight() * sy;
+    }
 
     if(mInvertedY)
     {
         // Flip the bitmap upside down
         graphics->Scale(1, -1);
-        graphics->DrawBitmap(mGraphicsBitmap, 0, -mImageClipRegionSize.m_y, mImageClipRegionSize.m_x, mImageClipRegionSize.m_y);
+        graphics->DrawBitmap(data.mGraphicsBitmap, left, top - box.m_height, width, height);
     }
     else
     {
-        graphics->DrawBitmap(mGraphicsBitmap, 0, 0, mImageClipRegionSize.m_x, mImageClipRegionSize.m_y);
+        graphics->DrawBitmap(data.mGraphicsBitmap, left, top, width, height);
     }
 
     graphics->PopState();
@@ -435,12 +628,12 @@ void Polygon::DrawCrosshair(std::shared_ptr<wxGraphicsContext> graphics, double
 */
 int Polygon::GetImageWidth()
 {
-    if(!Assert(mImage != nullptr, L"You must specify an image before you can call GetImageWidth()"))
+    if(!Assert(GetImage() != nullptr, L"You must specify an image before you can call GetImageWidth()"))
     {
         return 0;
     }
 
-    return mImage->GetWidth();
+    return GetImage()->GetWidth();
 }
 
 
@@ -451,12 +644,12 @@ int Polygon::GetImageWidth()
 */
 int Polygon::GetImageHeight()
 {
-    if(!Assert(mImage != nullptr, L"You must specify an image before you can call GetImageHeight()"))
+    if(!Assert(GetImage() != nullptr, L"You must specify an image before you can call GetImageHeight()"))
     {
         return 0;
     }
 
-    return mImage->GetHeight();
+    return GetImage()->GetHeight();
 }
 
 
@@ -476,9 +669,23 @@ bool Polygon::Assert(bool condition, wxString msg, const wxString &url)
 
     // Set a breakpoint on this line to determine where
     // in your code the error comes from.
+    if(!wxThread::IsMain())
+    {
+        // Polygons may be built on a worker thread, where
+        // the delayed message timer cannot be started
+        if(wxTheApp != nullptr)
+        {
+            wxTheApp->CallAfter([msg, url]() {
+                wxMessageBox(msg + L"\n" + url, L"Polygon Class Usage Error");
+            });
+        }
+
+        return false;
+    }
+
     if(mDelayedMessage == nullptr)
     {
-        mDelayedMessage = std::make_shared<DelayedMessage>();
+        mDelayedMessage = std::make_unique<DelayedMessage>();
     }
 
     mDelayedMessage->Fire(msg, url);
@@ -494,7 +701,7 @@ bool Polygon::Assert(bool condition, wxString msg, const wxString &url)
  */
 void Polygon::SetOpacity(double opacity)
 {
-    if(opacity != mOpacity)
+    if(float(opacity) != mOpacity)
     {
         if(!Assert(opacity >= 0 && opacity <= 1,
                    L"Values passed to Polygon::SetOpacity must be in the range 0 to 1."))
@@ -503,9 +710,12 @@ void Polygon::SetOpacity(double opacity)
         }
 
         // We have an opacity change
-        mOpacity = opacity;
+        mOpacity = float(opacity);
 #ifdef WIN32
-        mBitmapDirty = true;
+        if(GetImageData() != nullptr)
+        {
+            GetImageData()->mBitmapDirty = true;
+        }
 #endif
     }
 }
@@ -521,7 +731,8 @@ void Polygon::SetOpacity(double opacity)
  */
 double Polygon::AverageLuminance(int x, int y, int wid, int hit)
 {
-    assert(mMode == Mode::Image);
+    assert(GetImage() != nullptr);
+    auto image = GetImage();
 
     double sum = 0;
     int cnt = 0;
@@ -540,9 +751,9 @@ double Polygon::AverageLuminance(int x, int y, int wid, int hit)
                 continue;
             }
 
-            double red = mImage->GetRed(i, j);
-            double grn = mImage->GetGreen(i, j);
-            double blu = mImage->GetBlue(i, j);
+            double red = image->GetRed(i, j);
+            double grn = image->GetGreen(i, j);
+            double blu = image->GetBlue(i, j);
             sum += red + grn + blu;
             cnt += 3;
         }
@@ -562,7 +773,8 @@ double Polygon::AverageLuminance(int x, int y, int wid, int hit)
  */
 wxPoint2DDouble Polygon::Center()
 {
-    if(mPoints.size() < 3)
+    auto& points = GetPoints();
+    if(points.size() < 3)
     {
         // Our polygon MUST have at least three points
         Assert(false,
@@ -577,23 +789,67 @@ wxPoint2DDouble Polygon::Center()
     }
 
     wxPoint2DDouble center;
-    for(auto v : mPoints)
+    for(auto v : points)
     {
         center += v;
     }
 
-    center = center / (int)mPoints.size();
+    center = center / (int)points.size();
 
     return center;
 }
 
+/**
+ * Get the memory this polygon uses beyond the object itself.
+ *
+ * Counts the points not yet shared, the image data and the
+ * error dialog when they have been allocated, and this
+ * polygon's share of the points of its shared shape.
+ * @return Memory in bytes
+ */
+size_t Polygon::GetMemoryUsage()
+{
+    size_t bytes = 0;
+    if(mPendingPoints != nullptr)
+    {
+        bytes += sizeof(*mPendingPoints) + mPendingPoints->capacity() * sizeof(wxPoint2DDouble);
+    }
+
+    if(GetImageData() != nullptr)
+    {
+        bytes += sizeof(ImageData);
+    }
+
+    if(mDelayedMessage != nullptr)
+    {
+        bytes += sizeof(DelayedMessage);
+    }
+
+    return bytes + GetShapeMemoryUsage();
+}
+
+/**
+ * Get this polygon's share of the memory of its shared shape
+ * @return Memory in bytes, 0 if the polygon has no shape yet
+ */
+size_t Polygon::GetShapeMemoryUsage()
+{
+    if(mShape == nullptr)
+    {
+        return 0;
+    }
+
+    auto shared = sizeof(PolygonShape) + mShape->GetPoints().capacity() * sizeof(wxPoint2DDouble);
+    return shared / mShape.use_count();
+}
+
 /**
  * Get a bounding box that encloses the entire polygon
  * @return Bounding box
  */
 wxRect2DDouble Polygon::BoundingBox()
 {
-    if(mPoints.size() < 3)
+    if(GetPoints().size() < 3)
     {
         // Our polygon MUST have at least three points
         Assert(false,
@@ -608,17 +864,7 @@ wxRect2DDouble Polygon::BoundingBox()
         return wxRect2DDouble(-radius, -radius, radius*2, radius*2);
     }
 
-    auto p1x = mPoints[0].m_x;
-    auto p1y = mPoints[0].m_y;
-
-    wxRect2DDouble box(p1x, p1y, 0, 0);
-
-    for(auto v : mPoints)
-    {
-        box.Union(v);
-    }
-
-    return box;
+    return mShape->GetBox();
 }
 
 
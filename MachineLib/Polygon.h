@@ -2,7 +2,7 @@
  * @file Polygon.h
  *
  * @author Charles Owen
- * @version 1.05
+ * @version 1.13
  *
  * Generic polygon class that is used to make shapes we
  * will use in our project.
@@ -14,6 +14,14 @@
  * 1.03 Put into cse335 namespace, opacity support
  * 1.04 Added Circle function
  * 1.05 Special version that works with inverted Y axis
+ * 1.06 Images are shared through ImageCache
+ * 1.07 Image load failures can be reported from worker threads
+ * 1.08 Images can be drawn from a shared texture atlas
+ * 1.09 Added GetBounds
+ * 1.10 Shapes are shared through ShapeCache
+ * 1.11 Mode specific data and the error dialog are only allocated when used
+ * 1.12 Polygons can be built off the main thread, wx objects are created by CreateGraphics
+ * 1.13 An image is kept when a color is set after it, as before 1.11
  */
 
 #pragma once
@@ -21,6 +29,10 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <variant>
+
+#include "ImageCache.h"
+#include "PolygonShape.h"
 
 namespace cse335 {
 
@@ -36,49 +48,77 @@ namespace cse335 {
         void DrawColorPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double r);
         void DrawImagePolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double r);
 
-        /// Graphics path to use to draw
-        wxGraphicsPath mPath;
+        /// A color that has been set, but has no brush yet
+        struct PendingColor {
+            /// Red from 0 to 255
+            unsigned char mRed;
 
-        /// The points that make up the polygon
-        std::vector<wxPoint2DDouble> mPoints;
+            /// Green from 0 to 255
+            unsigned char mGreen;
 
-        /// Set true if this polygon is a circle
-        bool mIsCircle = false;
+            /// Blue from 0 to 255
+            unsigned char mBlue;
+
+            /// Alpha from 0 to 255
+            unsigned char mAlpha;
+        };
 
-        /// A brush to draw the polygon with
-        wxBrush mBrush;
+        /// What an image polygon needs to draw, only
+        /// allocated for polygons that have an image
+        struct ImageData {
+            /// The basic texture image we load, shared
+            /// with all other polygons using the same file
+            std::shared_ptr<CachedImage> mImage;
 
-        /// The display mode
-        enum class Mode {
-            Unset, Color, Image
+            /// The graphics bitmap we actually draw
+            wxGraphicsBitmap mGraphicsBitmap;
+
+            /// Is mGraphicsBitmap the atlas page our image is packed into?
+            bool mFromAtlas = false;
+
+            /// Forces the bitmap to be reloaded
+            bool mBitmapDirty = true;
+
+            /// A color set after the image, which is drawn instead
+            /// of it: nothing, a color until its brush is created,
+            /// or the brush. The image is still used for its size.
+            std::variant<std::monostate, PendingColor, wxBrush> mColor;
         };
 
-        /// The current mode
-        Mode mMode = Mode::Unset;
+        /// The points added to the polygon, until they are
+        /// replaced by the shape shared with all other polygons
+        /// that have the same points
+        std::unique_ptr<std::vector<wxPoint2DDouble>> mPendingPoints;
 
-        /// The basic texture image we load
-        std::unique_ptr<wxImage> mImage;
+        /// The shape of the polygon, shared with all
+        /// other polygons that have the same points
+        std::shared_ptr<PolygonShape> mShape;
 
-        /// The graphics bitmap we actually draw
-        wxGraphicsBitmap mGraphicsBitmap;
+        const std::shared_ptr<PolygonShape>& GetShape();
 
-        /// The image clip region
-        wxRegion mImageClipRegion;
+        const std::vector<wxPoint2DDouble>& GetPoints();
 
-        /// What is the top left point for the clip region?
-        wxPoint2DDouble mImageClipRegionTopLeft;
+        /// The display mode and what it draws with: nothing while
+        /// unset, a color until its brush is created, the brush
+        /// for a color or the image data for an image
+        std::variant<std::monostate, PendingColor, wxBrush, std::unique_ptr<ImageData>> mMode;
 
-        /// What is the size of the clip region?
-        wxPoint2DDouble mImageClipRegionSize;
+        ImageData* GetImageData();
 
-        /// Set true when DrawPolygon is called
-        bool mHasDrawn = false;
+        CachedImage* GetImage();
+
+        wxBrush* GetBrush();
+
+        bool IsColorPending();
 
         /// Opacity of the polygon - value range to 0 to 1
-        double mOpacity = 1.0;
+        float mOpacity = 1.0f;
+
+        /// Set true if this polygon is a circle
+        bool mIsCircle = false;
 
-        /// Forces the bitmap to be reloaded
-        bool mBitmapDirty = true;
+        /// Set true when DrawPolygon is called
+        bool mHasDrawn = false;
 
 #ifdef POLYGON_DEFAULT_INVERTEDY
         /// Is the Y axis inverted (positive Y is up)?
@@ -111,8 +151,8 @@ namespace cse335 {
             void Fire(const wxString& msg, const wxString& url = wxEmptyString);
         };
 
-        /// Delayed message object
-        std::shared_ptr<DelayedMessage> mDelayedMessage;
+        /// Delayed message object, created on the first failed assertion
+        std::unique_ptr<DelayedMessage> mDelayedMessage;
         //</editor-fold>
 
     public:
@@ -134,12 +174,16 @@ namespace cse335 {
 
         void CenteredSquare(double size = 0);
 
-        void SetColor(wxColour color);
+        void SetColor(const wxColour& color);
 
         void SetImage(std::wstring filename);
 
+        void CreateGraphics();
+
         void DrawPolygon(std::shared_ptr<wxGraphicsContext> graphics, double x, double y, double rotation);
 
+        wxRect2DDouble GetBounds(double x, double y, double rotation);
+
         virtual void SetOpacity(double opacity);
 
         int GetImageWidth();
@@ -177,24 +221,27 @@ namespace cse335 {
          * Get the radius if this is a circle
          * @return Radius in the display units
          */
-        double Radius() {return mPoints[0].m_x;}
+        double Radius() {return GetPoints()[0].m_x;}
 
         /**
          * Iterator begin function. Allows for iterating over the
          * vertices of the polygon.
          * @return Vertex iterator
          */
-        std::vector<wxPoint2DDouble>::iterator begin() {return mPoints.begin();}
+        std::vector<wxPoint2DDouble>::const_iterator begin() {return GetPoints().begin();}
 
         /**
          * Iterator end function. Allows for iterating over the
          * vertices of the polygon.
          * @return Vertex iterator
          */
-        std::vector<wxPoint2DDouble>::iterator end() {return mPoints.end();}
+        std::vector<wxPoint2DDouble>::const_iterator end() {return GetPoints().end();}
 
         wxPoint2DDouble Center();
         wxRect2DDouble BoundingBox();
+
+        size_t GetMemoryUsage();
+        size_t GetShapeMemoryUsage();
     };
 
 
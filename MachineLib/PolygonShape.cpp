@@ -0,0 +1,213 @@
+/**
+ * @file PolygonShape.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "PolygonShape.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace cse335;
+
+/// The shapes that have been created, keyed by their points
+std::map<std::vector<wxPoint2DDouble>, std::weak_ptr<PolygonShape>, ShapeCache::PointsLess> ShapeCache::mShapes;
+
+/// The circle shapes, keyed by radius and steps
+std::map<std::pair<double, int>, std::weak_ptr<PolygonShape>> ShapeCache::mCircles;
+
+/// Protects mShapes and mCircles
+std::mutex ShapeCache::mMutex;
+
+/// Entries a map of the cache holds before it is first swept
+const size_t MinimumSweepSize = 64;
+
+/// Size mShapes grows to before its expired entries are dropped
+size_t ShapeCache::mShapesLimit = MinimumSweepSize;
+
+/// Size mCircles grows to before its expired entries are dropped
+size_t ShapeCache::mCirclesLimit = MinimumSweepSize;
+
+/**
+ * Drop the entries of a cache map whose shape nobody uses
+ * anymore, once the map has grown to a limit. The limit is then
+ * twice what is left, so a map of shapes that are all in use is
+ * not swept on every insert.
+ * @param map Map of weak references to shapes
+ * @param limit Size at which to sweep, updated after the sweep
+ */
+template <class Map>
+static void DropExpired(Map& map, size_t& limit)
+{
+    if(map.size() < limit)
+    {
+        return;
+    }
+
+    for(auto i = map.begin(); i != map.end(); )
+    {
+        i = i->second.expired() ? map.erase(i) : std::next(i);
+    }
+
+    limit = std::max(map.size() * 2, MinimumSweepSize);
+}
+
+/**
+ * Constructor
+ * @param points The points that make up the shape, at least one
+ */
+PolygonShape::PolygonShape(std::vector<wxPoint2DDouble> points) : mPoints(std::move(points))
+{
+    auto topLeft = mPoints[0];
+    auto bottomRight = mPoints[0];
+    for(auto& point : mPoints)
+    {
+        topLeft.m_x = std::min(topLeft.m_x, point.m_x);
+        topLeft.m_y = std::min(topLeft.m_y, point.m_y);
+        bottomRight.m_x = std::max(bottomRight.m_x, point.m_x);
+        bottomRight.m_y = std::max(bottomRight.m_y, point.m_y);
+    }
+
+    mBox = wxRect2DDouble(topLeft.m_x, topLeft.m_y, bottomRight.m_x - topLeft.m_x, bottomRight.m_y - topLeft.m_y);
+}
+
+/**
+ * Get the clip region of the points, relative to the top
+ * left of the box, creating it the first time it is used.
+ * @return Clip region
+ */
+const wxRegion& PolygonShape::GetClipRegion()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(!mHasClipRegion)
+    {
+        std::vector<wxPoint> points;
+        for(auto& point : mPoints)
+        {
+            points.push_back(wxPoint(int(point.m_x - mBox.m_x + 0.5), int(point.m_y - mBox.m_y + 0.5)));
+        }
+
+        mClipRegion = wxRegion(points.size(), &points[0]);
+        mHasClipRegion = true;
+    }
+
+    return mClipRegion;
+}
+
+/**
+ * Get the graphics path of the shape, creating it
+ * the first time it is drawn with a renderer.
+ * @param graphics Graphics context we are drawing on
+ * @return Graphics path
+ */
+const wxGraphicsPath& PolygonShape::GetPath(std::shared_ptr<wxGraphicsContext> graphics)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto& path = mPaths[graphics->GetRenderer()];
+    if(path.IsNull())
+    {
+        path = graphics->CreatePath();
+        path.MoveToPoint(mPoints[0].m_x, mPoints[0].m_y);
+        for(size_t i=1; i<mPoints.size(); i++)
+        {
+            path.AddLineToPoint(mPoints[i].m_x, mPoints[i].m_y);
+        }
+        path.CloseSubpath();
+    }
+
+    return path;
+}
+
+/**
+ * Compare two point lists
+ * @param a First points
+ * @param b Second points
+ * @return true if a orders before b
+ */
+bool ShapeCache::PointsLess::operator()(const std::vector<wxPoint2DDouble>& a,
+                                        const std::vector<wxPoint2DDouble>& b) const
+{
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+        [](const wxPoint2DDouble& p, const wxPoint2DDouble& q) {
+            return p.m_x < q.m_x || (p.m_x == q.m_x && p.m_y < q.m_y);
+        });
+}
+
+/**
+ * Get the shape with some points, sharing it if it already exists
+ * @param points The points that make up the shape, at least one
+ * @return Shared shape
+ */
+std::shared_ptr<PolygonShape> ShapeCache::Intern(const std::vector<wxPoint2DDouble>& points)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    DropExpired(mShapes, mShapesLimit);
+
+    auto& cached = mShapes[points];
+    auto shape = cached.lock();
+    if(shape == nullptr)
+    {
+        shape = std::make_shared<PolygonShape>(points);
+        cached = shape;
+    }
+
+    return shape;
+}
+
+/**
+ * Get the shape of a circle centered on (0,0), sharing it if it
+ * already exists. The points are only computed the first time.
+ * @param radius Circle radius
+ * @param steps Number of points around the circle
+ * @return Shared shape
+ */
+std::shared_ptr<PolygonShape> ShapeCache::Circle(double radius, int steps)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    DropExpired(mCircles, mCirclesLimit);
+
+    auto& cached = mCircles[std::make_pair(radius, steps)];
+    auto shape = cached.lock();
+    if(shape == nullptr)
+    {
+        std::vector<wxPoint2DDouble> points;
+        points.reserve(steps);
+        for (int i = 0; i < steps; i++)
+        {
+            double angle = double(i) / double(steps) * M_PI * 2;
+            points.push_back(wxPoint2DDouble(radius * cos(angle), radius * sin(angle)));
+        }
+
+        shape = std::make_shared<PolygonShape>(std::move(points));
+        cached = shape;
+    }
+
+    return shape;
+}
+
+/**
+ * Get the number of shapes in use
+ * @return Number of shapes still used by a polygon
+ */
+size_t ShapeCache::GetCount()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    size_t count = 0;
+    for(auto& shape : mShapes)
+    {
+        count += shape.second.expired() ? 0 : 1;
+    }
+
+    for(auto& shape : mCircles)
+    {
+        count += shape.second.expired() ? 0 : 1;
+    }
+
+    return count;
+}
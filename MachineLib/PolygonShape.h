@@ -0,0 +1,117 @@
+/**
+ * @file PolygonShape.h
+ * @author Max Tetlow
+ *
+ * Process-wide cache of polygon shapes so polygons with
+ * the same points share one copy of their geometry.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cse335 {
+
+/**
+ * The geometry of a polygon, shared by every polygon with the same points.
+ *
+ * The points and the box around them never change once created,
+ * so a shape can be created on any thread. The clip region used to
+ * draw an image into the points and the graphics paths are only
+ * created on the thread that draws, the first time they are needed,
+ * and kept for every polygon that draws the shape after.
+ */
+class PolygonShape {
+private:
+    /// The points that make up the shape
+    std::vector<wxPoint2DDouble> mPoints;
+
+    /// Box around the points
+    wxRect2DDouble mBox;
+
+    /// Clip region of the points, relative to the top left of mBox
+    wxRegion mClipRegion;
+
+    /// Has mClipRegion been created?
+    bool mHasClipRegion = false;
+
+    /// Graphics paths created from the points, one per renderer
+    std::map<wxGraphicsRenderer*, wxGraphicsPath> mPaths;
+
+    /// Protects mClipRegion and mPaths, a shape can be drawn from more than one thread
+    std::mutex mMutex;
+
+public:
+    PolygonShape(std::vector<wxPoint2DDouble> points);
+
+    /// Default constructor (disabled)
+    PolygonShape() = delete;
+
+    /// Copy constructor (disabled)
+    PolygonShape(const PolygonShape &) = delete;
+
+    /// Assignment operator
+    void operator=(const PolygonShape &) = delete;
+
+    const wxGraphicsPath& GetPath(std::shared_ptr<wxGraphicsContext> graphics);
+
+    /**
+     * Get the points that make up the shape
+     * @return Points
+     */
+    const std::vector<wxPoint2DDouble>& GetPoints() const {return mPoints;}
+
+    /**
+     * Get the box around the points
+     * @return Box in the units of the points
+     */
+    const wxRect2DDouble& GetBox() const {return mBox;}
+
+    const wxRegion& GetClipRegion();
+};
+
+/**
+ * Process-wide cache of polygon shapes keyed by their points.
+ *
+ * The cache only holds weak references. A shape is freed
+ * when the last polygon using it is destroyed, and its entry
+ * is dropped the next time the cache has doubled in size.
+ */
+class ShapeCache {
+private:
+    /// Orders point lists so they can key a map
+    struct PointsLess {
+        bool operator()(const std::vector<wxPoint2DDouble>& a, const std::vector<wxPoint2DDouble>& b) const;
+    };
+
+    /// The shapes that have been created, keyed by their points
+    static std::map<std::vector<wxPoint2DDouble>, std::weak_ptr<PolygonShape>, PointsLess> mShapes;
+
+    /// The circle shapes, keyed by radius and steps
+    static std::map<std::pair<double, int>, std::weak_ptr<PolygonShape>> mCircles;
+
+    /// Protects mShapes and mCircles
+    static std::mutex mMutex;
+
+    /// Size mShapes grows to before its expired entries are dropped
+    static size_t mShapesLimit;
+
+    /// Size mCircles grows to before its expired entries are dropped
+    static size_t mCirclesLimit;
+
+public:
+    /// Constructor (disabled)
+    ShapeCache() = delete;
+
+    static std::shared_ptr<PolygonShape> Intern(const std::vector<wxPoint2DDouble>& points);
+
+    static std::shared_ptr<PolygonShape> Circle(double radius, int steps);
+
+    static size_t GetCount();
+};
+
+}
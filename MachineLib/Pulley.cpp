@@ -48,6 +48,32 @@ void Pulley::Draw(std::shared_ptr<wxGraphicsContext> graphics)
     }
 
     mPolygon.DrawPolygon(graphics, mLocation.x, mLocation.y, mRotation);
+
+    mDrawnRotation = mRotation;
+    mDrawn = true;
+}
+
+/**
+ * Get the rectangle the pulley and its belt draw in
+ *
+ * The belt ends are inside the radius of this pulley
+ * from each center, plus the width of the pen.
+ * @return Bounds in centimeters
+ */
+wxRect2DDouble Pulley::GetBounds()
+{
+    auto bounds = mPolygon.GetBounds(mLocation.x, mLocation.y, mRotation);
+
+    if(mPulley != nullptr)
+    {
+        auto margin = mRadius + 2;
+        for(auto point : {mLocation, mPulley->GetPosition()})
+        {
+            bounds.Union(wxRect2DDouble(point.x - margin, point.y - margin, margin * 2, margin * 2));
+        }
+    }
+
+    return bounds;
 }
 
 /**
@@ -68,13 +94,27 @@ void Pulley::Rotate(double rotation, double speed)
 {
     mSource.SetRotation(rotation, speed);
     mRotation = rotation;
-    if(mPulley != nullptr)
+
+    // A RotationGraph drives the pulley on the belt itself
+    if(mPulley != nullptr && !mSource.IsScheduled())
     {
-        mPulley->GetSource()->SetRotation(rotation, speed);
-        mPulley->Rotate(rotation, speed);
+        auto ratio = GetBeltRatio();
+        mPulley->Rotate(rotation * ratio, speed * ratio);
     }
 }
 
+/**
+ * Get how much faster the pulley this pulley drives turns.
+ *
+ * The belt moves both rims the same distance, so the
+ * driven pulley turns by the ratio of the radii.
+ * @return Ratio of driven rotation to this pulley's rotation
+ */
+double Pulley::GetBeltRatio()
+{
+    return mPulley == nullptr ? 1 : mRadius / mPulley->mRadius;
+}
+
 /**
  * function that links 2 pulleys together in the pulleys system
  * @param pulley the pulley that is being linked to this pulley
@@ -17,7 +17,7 @@ class RotationSource;
 /**
  * class that represents a pulley component in the machine
  */
-class Pulley : public Component, public RotationSink
+class Pulley final : public Component, public RotationSink
 {
 private:
 
@@ -45,6 +45,15 @@ private:
     ///the location of the pulley
     wxPoint mLocation;
 
+    ///the rotation the pulley was last drawn at
+    double mDrawnRotation = 0;
+
+    ///weather or not the pulley has been drawn
+    bool mDrawn = false;
+
+    ///the rotation the pulley had the last time it was checked for rest
+    double mRestingRotation = 0;
+
 public:
 
     Pulley(double radius);
@@ -61,6 +70,25 @@ public:
 
     void Rotate(double rotation, double speed) override;
 
+    wxRect2DDouble GetBounds() override;
+
+    /**
+     * Has the pulley turned since it was last drawn?
+     * @return true if the pulley has turned
+     */
+    bool IsChanged() override {return !mDrawn || mRotation != mDrawnRotation;}
+
+    /**
+     * Has the pulley kept still since it was last checked?
+     * @return true if the pulley is at rest
+     */
+    bool IsResting() override
+    {
+        auto resting = mRotation == mRestingRotation;
+        mRestingRotation = mRotation;
+        return resting;
+    }
+
     /**
      * sets the physics for the pulley, just sets rotation to zero
      * @param listen the contact listener for the physics world
@@ -70,6 +98,26 @@ public:
 
     void Drive(std::shared_ptr<Pulley> pulley);
 
+    double GetBeltRatio();
+
+    /**
+     * Get the pulley this pulley drives with a belt
+     * @return Driven pulley or nullptr
+     */
+    std::shared_ptr<Pulley> GetDriven() {return mPulley;}
+
+    /**
+     * Save the pulley rotation
+     * @param state Vector to append the state values to
+     */
+    void SaveState(std::vector<double>& state) override {state.push_back(mRotation);}
+
+    /**
+     * Restore the state saved by SaveState
+     * @param state Iterator to read the state values from
+     */
+    void RestoreState(std::vector<double>::const_iterator& state) override {mRotation = *state++;}
+
     /**
      * Get the position of the polley
      * @return the position of the pulley
@@ -0,0 +1,208 @@
+/**
+ * @file RotationGraph.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "RotationGraph.h"
+#include "ComponentStore.h"
+#include "Hamster.h"
+#include "Pulley.h"
+#include "RotationSource.h"
+
+#include <map>
+
+/**
+ * Constructor
+ */
+RotationGraph::RotationGraph()
+{
+}
+
+/**
+ * Destructor
+ */
+RotationGraph::~RotationGraph()
+{
+    Clear();
+}
+
+/**
+ * Compile the schedule for the links between the components.
+ *
+ * A sink has one driver. If a sink is linked to more than one,
+ * the last link found drives it. Sinks whose drivers lead back
+ * to themselves are left out of the schedule and never rotate.
+ * @param components The components of the machine
+ * @return true if there are no cycles
+ */
+bool RotationGraph::Compile(const ComponentStore& components)
+{
+    Clear();
+
+    // A sink while the graph is being compiled
+    struct Node
+    {
+        RotationSink* mSink = nullptr;
+        int mRoot = -1;
+        int mParent = -1;
+        double mRatio = 1;
+        int mStep = -1;
+    };
+
+    std::vector<Node> nodes;
+    std::map<RotationSink*, int> indices;
+    auto find = [&nodes, &indices](RotationSink* sink) {
+        auto index = indices.find(sink);
+        if(index != indices.end())
+        {
+            return index->second;
+        }
+
+        Node node;
+        node.mSink = sink;
+        nodes.push_back(node);
+        indices[sink] = int(nodes.size()) - 1;
+        return int(nodes.size()) - 1;
+    };
+
+    for(auto hamster : components.GetHamsters())
+    {
+        auto source = hamster->GetSource();
+        for(auto& sink : source->GetSinks())
+        {
+            auto& node = nodes[find(sink.get())];
+            node.mRoot = int(mRoots.size());
+            node.mParent = -1;
+            node.mRatio = 1;
+        }
+
+        mRoots.push_back(source);
+        mScheduled.push_back(source);
+    }
+
+    for(auto pulley : components.GetPulleys())
+    {
+        auto parent = find(pulley);
+        for(auto& sink : pulley->GetSource()->GetSinks())
+        {
+            auto& node = nodes[find(sink.get())];
+            node.mRoot = -1;
+            node.mParent = parent;
+            node.mRatio = 1;
+        }
+
+        auto driven = pulley->GetDriven();
+        if(driven != nullptr)
+        {
+            auto& node = nodes[find(driven.get())];
+            node.mRoot = -1;
+            node.mParent = parent;
+            node.mRatio = pulley->GetBeltRatio();
+        }
+
+        mScheduled.push_back(pulley->GetSource());
+    }
+
+    // Breadth first from the roots, so every
+    // sink comes after the sink that drives it
+    std::vector<std::vector<int>> children(nodes.size());
+    std::vector<int> queue;
+    for(int n=0; n<(int)nodes.size(); n++)
+    {
+        if(nodes[n].mRoot >= 0)
+        {
+            queue.push_back(n);
+        }
+        else if(nodes[n].mParent >= 0)
+        {
+            children[nodes[n].mParent].push_back(n);
+        }
+    }
+
+    int roots = int(mRoots.size());
+    for(size_t q=0; q<queue.size(); q++)
+    {
+        auto& node = nodes[queue[q]];
+        node.mStep = int(mSteps.size());
+
+        Step step;
+        step.mSink = node.mSink;
+        step.mParent = node.mRoot >= 0 ? node.mRoot : roots + nodes[node.mParent].mStep;
+        step.mRatio = node.mRatio;
+        mSteps.push_back(step);
+
+        for(auto child : children[queue[q]])
+        {
+            queue.push_back(child);
+        }
+    }
+
+    // A sink that was not reached either has no driver at all,
+    // or its drivers go around in a cycle
+    for(auto& node : nodes)
+    {
+        if(node.mStep >= 0)
+        {
+            continue;
+        }
+
+        auto parent = node.mParent;
+        for(size_t i=0; parent >= 0 && i<nodes.size(); i++)
+        {
+            parent = nodes[parent].mParent;
+        }
+
+        if(parent >= 0)
+        {
+            mCycles++;
+        }
+    }
+
+    for(auto source : mScheduled)
+    {
+        source->SetScheduled(true);
+    }
+
+    mValues.resize(mRoots.size() + mSteps.size());
+    return mCycles == 0;
+}
+
+/**
+ * Remove the schedule. The sources drive
+ * their sinks directly again.
+ */
+void RotationGraph::Clear()
+{
+    for(auto source : mScheduled)
+    {
+        source->SetScheduled(false);
+    }
+
+    mRoots.clear();
+    mSteps.clear();
+    mValues.clear();
+    mScheduled.clear();
+    mCycles = 0;
+}
+
+/**
+ * Propagate the rotation of the roots to every sink
+ */
+void RotationGraph::Propagate()
+{
+    size_t v = 0;
+    for(; v < mRoots.size(); v++)
+    {
+        mValues[v] = {mRoots[v]->GetRotation(), mRoots[v]->GetSpeed()};
+    }
+
+    for(auto& step : mSteps)
+    {
+        auto& parent = mValues[step.mParent];
+        auto& value = mValues[v++];
+        value.first = parent.first * step.mRatio;
+        value.second = parent.second * step.mRatio;
+        step.mSink->Rotate(value.first, value.second);
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * @file RotationGraph.h
+ * @author Max Tetlow
+ *
+ * Flat schedule that propagates rotation from the
+ * hamsters to every rotation sink once per step.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_ROTATIONGRAPH_H
+#define CANADIANEXPERIENCE_MACHINELIB_ROTATIONGRAPH_H
+
+#include <utility>
+#include <vector>
+
+class ComponentStore;
+class RotationSource;
+class RotationSink;
+
+/**
+ * Flat schedule that propagates rotation from the
+ * hamsters to every rotation sink once per step.
+ *
+ * The source to sink links and pulley belts form trees rooted
+ * at the hamsters. Compile walks them once after the machine is
+ * built and lists every sink after the sink that drives it,
+ * along with the gear ratio of the edge into it. Belts between
+ * pulleys of different radii change the rotation by the ratio
+ * of the radii, links are one to one.
+ *
+ * Propagate then reads each hamster's rotation and evaluates the
+ * list in order, so each sink is rotated exactly once per step.
+ * The sources in the graph only record their rotation while
+ * the graph is compiled.
+ */
+class RotationGraph
+{
+private:
+    /// One sink in the schedule
+    struct Step
+    {
+        /// The sink to rotate
+        RotationSink* mSink = nullptr;
+
+        /// Index of the value that drives this sink, a root
+        /// or an earlier step offset by the number of roots
+        int mParent = 0;
+
+        /// Rotation of this sink per rotation of its parent
+        double mRatio = 1;
+    };
+
+    /// The sources the rotation starts from
+    std::vector<RotationSource*> mRoots;
+
+    /// The sinks, each after the sink that drives it
+    std::vector<Step> mSteps;
+
+    /// Rotation and speed for the roots followed by the steps
+    std::vector<std::pair<double, double>> mValues;
+
+    /// Sources the graph is driving the sinks of
+    std::vector<RotationSource*> mScheduled;
+
+    /// Number of sinks left out because they are driven in a cycle
+    int mCycles = 0;
+
+public:
+    RotationGraph();
+
+    ~RotationGraph();
+
+    /// Copy constructor (disabled)
+    RotationGraph(const RotationGraph &) = delete;
+
+    /// Assignment operator
+    void operator=(const RotationGraph &) = delete;
+
+    bool Compile(const ComponentStore& components);
+
+    void Clear();
+
+    void Propagate();
+
+    /**
+     * Get the number of sinks in the schedule
+     * @return Number of sinks
+     */
+    size_t GetSinkCount() const {return mSteps.size();}
+
+    /**
+     * Get the number of sinks that were left out of
+     * the schedule because they are driven in a cycle
+     * @return Number of sinks
+     */
+    int GetCycleCount() const {return mCycles;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_ROTATIONGRAPH_H
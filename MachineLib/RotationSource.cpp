@@ -27,12 +27,23 @@ void RotationSource::AddSink(std::shared_ptr<RotationSink> sink)
 
 /**
  * Sets the rotation for rotation sinks
+ *
+ * When a RotationGraph drives the sinks the rotation is
+ * only recorded for the graph to propagate.
  * @param r the rotation
  * @param speed the rotation speed
  */
 void RotationSource::SetRotation(double r, double speed)
 {
-    for (auto sink : mSinks)
+    mRotation = r;
+    mSpeed = speed;
+
+    if(mScheduled)
+    {
+        return;
+    }
+
+    for (auto& sink : mSinks)
     {
         sink->Rotate(r, speed);
     }
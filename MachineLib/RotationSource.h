@@ -24,6 +24,16 @@ private:
     ///Vector of the rotation sinks
     std::vector<std::shared_ptr<RotationSink>> mSinks;
 
+    /// The last rotation set
+    double mRotation = 0;
+
+    /// The last speed set
+    double mSpeed = 0;
+
+    /// Set when a RotationGraph drives the sinks, so
+    /// SetRotation only records the rotation
+    bool mScheduled = false;
+
 public:
 
     /// Copy constructor (disabled)
@@ -38,6 +48,36 @@ public:
 
     void SetRotation(double r, double speed);
 
+    /**
+     * Get the sinks this source drives
+     * @return Vector of sinks
+     */
+    const std::vector<std::shared_ptr<RotationSink>>& GetSinks() const {return mSinks;}
+
+    /**
+     * Get the last rotation set
+     * @return Rotation
+     */
+    double GetRotation() const {return mRotation;}
+
+    /**
+     * Get the last speed set
+     * @return Speed
+     */
+    double GetSpeed() const {return mSpeed;}
+
+    /**
+     * Set whether a RotationGraph drives the sinks of this source
+     * @param scheduled true if the sinks are driven by a graph
+     */
+    void SetScheduled(bool scheduled) {mScheduled = scheduled;}
+
+    /**
+     * Is a RotationGraph driving the sinks of this source?
+     * @return true if the sinks are driven by a graph
+     */
+    bool IsScheduled() const {return mScheduled;}
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_ROTATIONSOURCE_H
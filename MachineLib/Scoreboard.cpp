@@ -71,6 +71,30 @@ void Scoreboard::Draw(std::shared_ptr<wxGraphicsContext> graphics)
     graphics->DrawText(scoreString,0,0);
 
     graphics->PopState();
+
+    mDrawnScore = mScore;
+}
+
+/**
+ * function that gets the rectangle the scoreboard draws in
+ *
+ * The text is not measured, it is allowed a box twice
+ * the font size in each direction below its location.
+ * @return the bounds in cm
+ */
+wxRect2DDouble Scoreboard::GetBounds()
+{
+    auto point = mGoal->GetPosition();
+    auto dp = point + wxPoint(ScoreboardRectangle.x , ScoreboardRectangle.y);
+
+    wxRect2DDouble bounds(dp.x - ScoreboarderLineWidth, dp.y - ScoreboarderLineWidth,
+                          ScoreboardRectangle.width + ScoreboarderLineWidth * 2,
+                          ScoreboardRectangle.height + ScoreboarderLineWidth * 2);
+
+    // The text is drawn flipped, so it hangs below its location
+    bounds.Union(wxRect2DDouble(ScoreboardTextLocation.x/2 + dp.x, ScoreboardTextLocation.y - ScoreboardFontSize * 2,
+                                ScoreboardFontSize * 2, ScoreboardFontSize * 2));
+    return bounds;
 }
 
 /**
@@ -23,6 +23,9 @@ private:
     ///the score on the score board
     int mScore = 0;
 
+    ///the score the board was last drawn with, -1 if not drawn
+    int mDrawnScore = -1;
+
 public:
 
     /// Assignment operator
@@ -46,6 +49,14 @@ public:
 
     void SetGoal(BasketballGoal* goal);
 
+    wxRect2DDouble GetBounds();
+
+    /**
+     * Has the score changed since the board was last drawn?
+     * @return true if the score has changed
+     */
+    bool IsChanged() {return mScore != mDrawnScore;}
+
 };
 
 #endif //CANADIANEXPERIENCE_MACHINELIB_SCOREBOARD_H
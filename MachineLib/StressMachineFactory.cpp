@@ -0,0 +1,325 @@
+/**
+ * @file StressMachineFactory.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "StressMachineFactory.h"
+#include "Machine.h"
+#include "Body.h"
+#include "Hamster.h"
+#include "Conveyor.h"
+#include "Pulley.h"
+#include "HamsterAndConveyorFactory.h"
+
+#include <algorithm>
+
+/// The images directory in resources
+const std::wstring ImagesDirectory = L"/images";
+
+/// Most columns any region is laid out in, regions grow upwards
+const int MaxColumns = 4;
+
+/// Space between regions in centimeters
+const double RegionGap = 80;
+
+/// Height of the floor
+const double FloorHeight = 15;
+
+/// Width of a domino shelf
+const double ShelfWidth = 150;
+
+/// Height of a domino shelf
+const double ShelfHeight = 15;
+
+/// Dominoes on each shelf
+const int DominoesPerShelf = 10;
+
+/// Distance between domino shelves
+const wxPoint2DDouble ShelfSpacing(170, 60);
+
+/// Height of a Domino
+const double DominoHeight = 25;
+
+/// Width of a Domino
+const double DominoWidth = 5;
+
+/// Domino images, used in turn
+const std::wstring DominoImages[] = {L"/domino-black.png", L"/domino-red.png", L"/domino-green.png", L"/domino-blue.png"};
+
+/// Width of a ball bin
+const double BinWidth = 100;
+
+/// Height of the walls of a ball bin
+const double BinHeight = 300;
+
+/// Thickness of the walls of a ball bin
+const double BinWall = 10;
+
+/// Balls dropped into each bin
+const int BallsPerBin = 40;
+
+/// Balls across each row above a bin
+const int BallsPerRow = 3;
+
+/// Distance between ball bins. The balls start above the
+/// walls, so bins are further apart vertically than they are tall
+const wxPoint2DDouble BinSpacing(130, 450);
+
+/// Radius of a ball
+const double BallRadius = 12;
+
+/// Ball images, used in turn
+const std::wstring BallImages[] = {L"/basketball1.png", L"/basketball2.png", L"/ball1.png"};
+
+/// Distance between hamster and conveyor assemblies
+const wxPoint2DDouble ConveyorSpacing(260, 180);
+
+/// Pulleys in each pulley train
+const int PulleysPerTrain = 10;
+
+/// Radius of a pulley in a train
+const double PulleyRadius = 10;
+
+/// Distance between pulleys in a train
+const double PulleySpacing = 25;
+
+/// Distance between pulley trains
+const wxPoint2DDouble TrainSpacing(320, 80);
+
+/**
+ * Number of columns a region with some number of items uses
+ * @param count Number of items
+ * @return Number of columns
+ */
+static int Columns(int count)
+{
+    return std::max(1, std::min(count, MaxColumns));
+}
+
+/**
+ * Constructor
+ * @param resourcesDir Path to the resources directory
+ */
+StressMachineFactory::StressMachineFactory(std::wstring resourcesDir) :
+    mResourcesDir(resourcesDir)
+{
+    mImagesDir = mResourcesDir + ImagesDirectory;
+}
+
+/**
+ * Choose the number of each part of the machine
+ * so it has about some number of physics bodies.
+ *
+ * Half of the bodies are dominoes, a third are balls in
+ * bins and the rest are conveyor assemblies and pulley trains.
+ * @param bodies Number of physics bodies
+ */
+void StressMachineFactory::SetBodyCount(int bodies)
+{
+    mShelves = std::max(1, bodies / 2 / (DominoesPerShelf + 1));
+    mBins = std::max(1, bodies / 3 / (BallsPerBin + 3));
+
+    // A base beam, hamster cage, conveyor and ball each
+    mConveyors = std::max(1, bodies / 7 / 4);
+
+    // Only the hamster cage is a physics body, the trains are
+    // there for the rotation sources and sinks
+    mPulleyTrains = std::max(1, bodies / 200);
+}
+
+/**
+ * Factory method to create the machine
+ * @return The created machine
+ */
+std::shared_ptr<Machine> StressMachineFactory::Create()
+{
+    auto machine = std::make_shared<Machine>(FirstMachineNumber);
+
+    // Notice: All dimensions are in centimeters and assumes
+    // the Y axis is positive in the up direction.
+
+    //
+    // The floor. It is added first so it draws behind
+    // everything, but it is sized once the regions are laid out
+    //
+    auto floor = std::make_shared<Body>();
+    floor->GetPolygon()->SetImage(mImagesDir + L"/floor.png");
+    machine->AddComponent(floor);
+
+    double x = 0;
+    x = DominoShelves(machine, x) + RegionGap;
+    x = BallBins(machine, x) + RegionGap;
+    x = Conveyors(machine, x) + RegionGap;
+    x = PulleyTrains(machine, x);
+
+    floor->GetPolygon()->Rectangle(-RegionGap, -FloorHeight, x + RegionGap * 2, FloorHeight);
+
+    return machine;
+}
+
+/**
+ * Create the shelves of dominoes.
+ *
+ * The first domino on each shelf leans over so the
+ * whole row topples as soon as the machine starts.
+ * @param machine Machine to add to
+ * @param x Left side of the region
+ * @return Right side of the region
+ */
+double StressMachineFactory::DominoShelves(std::shared_ptr<Machine> machine, double x)
+{
+    for(int s=0; s<mShelves; s++)
+    {
+        auto position = wxPoint2DDouble(x + (s % MaxColumns) * ShelfSpacing.m_x + ShelfWidth / 2,
+                                        (s / MaxColumns) * ShelfSpacing.m_y);
+
+        auto shelf = std::make_shared<Body>();
+        shelf->GetPolygon()->BottomCenteredRectangle(ShelfWidth, ShelfHeight);
+        shelf->GetPolygon()->SetImage(mImagesDir + L"/beam.png");
+        shelf->GetPolygon()->SetInitialPosition(position.m_x, position.m_y);
+        machine->AddComponent(shelf);
+
+        for(int d=0; d<DominoesPerShelf; d++)
+        {
+            auto domino = std::make_shared<Body>();
+            domino->GetPolygon()->Rectangle(-DominoWidth/2, -DominoHeight/2, DominoWidth, DominoHeight);
+            domino->GetPolygon()->SetImage(mImagesDir + DominoImages[(s + d) % 4]);
+            domino->GetPolygon()->SetInitialPosition(position.m_x - 70 + d * 15,
+                                                     position.m_y + ShelfHeight + DominoHeight / 2);
+            domino->GetPolygon()->SetInitialRotation(d == 0 ? -0.03 : 0);
+            domino->GetPolygon()->SetDynamic();
+            machine->AddComponent(domino);
+        }
+    }
+
+    return x + Columns(mShelves) * ShelfSpacing.m_x;
+}
+
+/**
+ * Create the bins with balls falling into them
+ * @param machine Machine to add to
+ * @param x Left side of the region
+ * @return Right side of the region
+ */
+double StressMachineFactory::BallBins(std::shared_ptr<Machine> machine, double x)
+{
+    for(int b=0; b<mBins; b++)
+    {
+        auto left = x + (b % MaxColumns) * BinSpacing.m_x;
+        auto bottom = (b / MaxColumns) * BinSpacing.m_y;
+
+        auto base = std::make_shared<Body>();
+        base->GetPolygon()->BottomCenteredRectangle(BinWidth, BinWall);
+        base->GetPolygon()->SetImage(mImagesDir + L"/beam.png");
+        base->GetPolygon()->SetInitialPosition(left + BinWidth / 2, bottom);
+        machine->AddComponent(base);
+
+        for(auto wallX : {left + BinWall / 2, left + BinWidth - BinWall / 2})
+        {
+            auto wall = std::make_shared<Body>();
+            wall->GetPolygon()->BottomCenteredRectangle(BinWall, BinHeight);
+            wall->GetPolygon()->SetImage(mImagesDir + L"/beam2.png");
+            wall->GetPolygon()->SetInitialPosition(wallX, bottom + BinWall);
+            machine->AddComponent(wall);
+        }
+
+        for(int i=0; i<BallsPerBin; i++)
+        {
+            int row = i / BallsPerRow;
+
+            // Alternate rows are shifted a little so the
+            // balls do not balance on top of each other
+            auto ballX = left + BinWall + 15 + (i % BallsPerRow) * (BallRadius * 2 + 1) + (row % 2 ? 1 : -1);
+            auto ballY = bottom + BinWall + BallRadius + 1 + row * (BallRadius * 2 + 3);
+
+            auto ball = std::make_shared<Body>();
+            ball->GetPolygon()->Circle(BallRadius);
+            ball->GetPolygon()->SetImage(mImagesDir + BallImages[i % 3]);
+            ball->GetPolygon()->SetInitialPosition(ballX, ballY);
+            ball->GetPolygon()->SetDynamic();
+            ball->GetPolygon()->SetPhysics(1, 0.5, 0.6);
+            machine->AddComponent(ball);
+        }
+    }
+
+    return x + Columns(mBins) * BinSpacing.m_x;
+}
+
+/**
+ * Create the hamster and conveyor assemblies. Each sits on
+ * its own beam and carries a ball off the end of the conveyor.
+ * @param machine Machine to add to
+ * @param x Left side of the region
+ * @return Right side of the region
+ */
+double StressMachineFactory::Conveyors(std::shared_ptr<Machine> machine, double x)
+{
+    HamsterAndConveyorFactory hamsterAndConveyorFactory(machine, mImagesDir);
+
+    for(int c=0; c<mConveyors; c++)
+    {
+        auto left = x + (c % MaxColumns) * ConveyorSpacing.m_x;
+        auto bottom = (c / MaxColumns) * ConveyorSpacing.m_y;
+
+        auto base = std::make_shared<Body>();
+        base->GetPolygon()->BottomCenteredRectangle(ConveyorSpacing.m_x - 20, 10);
+        base->GetPolygon()->SetImage(mImagesDir + L"/beam.png");
+        base->GetPolygon()->SetInitialPosition(left + ConveyorSpacing.m_x / 2, bottom);
+        machine->AddComponent(base);
+
+        hamsterAndConveyorFactory.Create(wxPoint(int(left + 200), int(bottom + 10)),
+                                         wxPoint(int(left + 80), int(bottom + 100)));
+        hamsterAndConveyorFactory.AddBall(c % 2 ? 40 : -40);
+
+        auto hamster = hamsterAndConveyorFactory.GetHamster();
+        hamster->SetInitiallyRunning(true);
+        hamster->SetSpeed(c % 2 ? 1 : -1);
+    }
+
+    return x + Columns(mConveyors) * ConveyorSpacing.m_x;
+}
+
+/**
+ * Create the pulley trains. Each is a running hamster
+ * driving a row of pulleys, each driving the next.
+ * @param machine Machine to add to
+ * @param x Left side of the region
+ * @return Right side of the region
+ */
+double StressMachineFactory::PulleyTrains(std::shared_ptr<Machine> machine, double x)
+{
+    for(int t=0; t<mPulleyTrains; t++)
+    {
+        auto left = x + (t % MaxColumns) * TrainSpacing.m_x;
+        auto bottom = (t / MaxColumns) * TrainSpacing.m_y;
+
+        auto hamster = std::make_shared<Hamster>(mImagesDir);
+        hamster->SetPosition(int(left + 40), int(bottom));
+        hamster->SetInitiallyRunning(true);
+        machine->AddComponent(hamster);
+        auto shaft = hamster->GetShaftPosition();
+
+        std::shared_ptr<Pulley> previous;
+        for(int p=0; p<PulleysPerTrain; p++)
+        {
+            auto pulley = std::make_shared<Pulley>(PulleyRadius);
+            pulley->GetPolygon()->SetImage(mImagesDir + L"/pulley3.png");
+            pulley->SetPosition(shaft + wxPoint(int(p * PulleySpacing), 0));
+            machine->AddComponent(pulley);
+
+            if(previous == nullptr)
+            {
+                hamster->GetSource()->AddSink(pulley);
+            }
+            else
+            {
+                previous->Drive(pulley);
+            }
+
+            previous = pulley;
+        }
+    }
+
+    return x + Columns(mPulleyTrains) * TrainSpacing.m_x;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file StressMachineFactory.h
+ * @author Max Tetlow
+ *
+ * Factory that generates large machines for scaling tests.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_STRESSMACHINEFACTORY_H
+#define CANADIANEXPERIENCE_MACHINELIB_STRESSMACHINEFACTORY_H
+
+#include <memory>
+#include <string>
+
+class Machine;
+
+/**
+ * Factory that generates large machines for scaling tests.
+ *
+ * The machine is made of four regions side by side on one
+ * long floor: shelves of dominoes that topple, bins that
+ * balls cascade into, hamster and conveyor assemblies from
+ * HamsterAndConveyorFactory, and trains of pulleys driven by
+ * a hamster. The number of each is configurable, and the
+ * layout is always the same for the same counts so runs
+ * can be compared.
+ *
+ * Machine numbers at or above FirstMachineNumber select a
+ * generated machine with about that many physics bodies.
+ */
+class StressMachineFactory {
+private:
+    /// Path to the resources directory
+    std::wstring mResourcesDir;
+
+    /// Path to the images directory
+    std::wstring mImagesDir;
+
+    /// Number of shelves of dominoes
+    int mShelves = 1;
+
+    /// Number of bins of balls
+    int mBins = 1;
+
+    /// Number of hamster and conveyor assemblies
+    int mConveyors = 1;
+
+    /// Number of pulley trains
+    int mPulleyTrains = 1;
+
+    double DominoShelves(std::shared_ptr<Machine> machine, double x);
+    double BallBins(std::shared_ptr<Machine> machine, double x);
+    double Conveyors(std::shared_ptr<Machine> machine, double x);
+    double PulleyTrains(std::shared_ptr<Machine> machine, double x);
+
+public:
+    /// Smallest machine number that selects a generated machine
+    static const int FirstMachineNumber = 100;
+
+    StressMachineFactory(std::wstring resourcesDir);
+
+    /// Default constructor (disabled)
+    StressMachineFactory() = delete;
+
+    void SetBodyCount(int bodies);
+
+    /**
+     * Set the number of shelves of dominoes
+     * @param shelves Number of shelves, each with a beam and ten dominoes
+     */
+    void SetShelves(int shelves) {mShelves = shelves;}
+
+    /**
+     * Set the number of bins of balls
+     * @param bins Number of bins, each with three walls and forty balls
+     */
+    void SetBins(int bins) {mBins = bins;}
+
+    /**
+     * Set the number of hamster and conveyor assemblies
+     * @param conveyors Number of assemblies
+     */
+    void SetConveyors(int conveyors) {mConveyors = conveyors;}
+
+    /**
+     * Set the number of pulley trains
+     * @param trains Number of trains, each a hamster driving ten pulleys
+     */
+    void SetPulleyTrains(int trains) {mPulleyTrains = trains;}
+
+    std::shared_ptr<Machine> Create();
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_STRESSMACHINEFACTORY_H
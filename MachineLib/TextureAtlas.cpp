@@ -0,0 +1,124 @@
+/**
+ * @file TextureAtlas.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace cse335;
+
+/**
+ * Copy an image into an atlas page, extending its
+ * edge pixels out into the padding around it
+ * @param page Atlas page to copy into
+ * @param image Image to copy
+ * @param rect Where the image goes in the page, not including padding
+ */
+static void CopyIntoPage(CachedImage& page, CachedImage& image, const wxRect& rect)
+{
+    auto pageWidth = page.GetWidth();
+    auto pageData = page.GetData();
+    auto pageAlpha = page.GetAlpha();
+    auto data = image.GetData();
+
+    // Opaque images have no alpha channel
+    auto alpha = image.GetAlpha();
+
+    for(int y = -TextureAtlas::Padding; y < rect.height + TextureAtlas::Padding; y++)
+    {
+        int sy = std::clamp(y, 0, rect.height - 1);
+        for(int x = -TextureAtlas::Padding; x < rect.width + TextureAtlas::Padding; x++)
+        {
+            int sx = std::clamp(x, 0, rect.width - 1);
+            auto from = sy * rect.width + sx;
+            auto to = (rect.y + y) * pageWidth + rect.x + x;
+
+            std::memcpy(pageData + to * 3, data + from * 3, 3);
+            pageAlpha[to] = alpha != nullptr ? alpha[from] : 255;
+        }
+    }
+}
+
+/**
+ * Pack images into atlas pages.
+ *
+ * Images too big to fit on a page are left out and
+ * are drawn from their own bitmap as before.
+ * @param images Images to pack
+ * @return The atlas pages
+ */
+std::vector<std::shared_ptr<CachedImage>> TextureAtlas::Pack(const std::vector<std::shared_ptr<CachedImage>>& images)
+{
+    std::vector<std::shared_ptr<CachedImage>> sorted;
+    for(auto& image : images)
+    {
+        if(image->IsOk() && image->GetWidth() > 0 && image->GetHeight() > 0 &&
+            image->GetWidth() + Padding * 2 <= PageSize && image->GetHeight() + Padding * 2 <= PageSize)
+        {
+            sorted.push_back(image);
+        }
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) {
+        return a->GetHeight() > b->GetHeight();
+    });
+
+    // Place the images on shelves, starting a new
+    // page when a shelf no longer fits on the page
+    std::vector<int> pages;
+    std::vector<wxRect> rects;
+    std::vector<wxSize> pageSizes(1);
+    int x = 0, y = 0, shelf = 0;
+    for(auto& image : sorted)
+    {
+        int width = image->GetWidth() + Padding * 2;
+        int height = image->GetHeight() + Padding * 2;
+
+        if(x + width > PageSize)
+        {
+            y += shelf;
+            x = 0;
+            shelf = 0;
+        }
+
+        if(y + height > PageSize)
+        {
+            pageSizes.emplace_back();
+            x = y = shelf = 0;
+        }
+
+        pages.push_back(int(pageSizes.size()) - 1);
+        rects.emplace_back(x + Padding, y + Padding, image->GetWidth(), image->GetHeight());
+
+        x += width;
+        shelf = std::max(shelf, height);
+
+        auto& size = pageSizes.back();
+        size.x = std::max(size.x, x);
+        size.y = std::max(size.y, y + shelf);
+    }
+
+    std::vector<std::shared_ptr<CachedImage>> atlas;
+    if(sorted.empty())
+    {
+        return atlas;
+    }
+
+    for(auto size : pageSizes)
+    {
+        // Fully transparent to start with
+        atlas.push_back(std::make_shared<CachedImage>(size.x, size.y));
+    }
+
+    for(size_t i=0; i<sorted.size(); i++)
+    {
+        CopyIntoPage(*atlas[pages[i]], *sorted[i], rects[i]);
+        sorted[i]->SetAtlas(atlas[pages[i]], rects[i]);
+    }
+
+    return atlas;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file TextureAtlas.h
+ * @author Max Tetlow
+ *
+ * Packs many images into a few large atlas images.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "ImageCache.h"
+
+namespace cse335 {
+
+/**
+ * Packs many images into a few large atlas images.
+ *
+ * Images are placed on shelves, tallest first. Each image is
+ * surrounded by a border of copies of its edge pixels, so
+ * filtering when a polygon samples its part of the atlas never
+ * picks up a neighbour. Every packed image is told which atlas
+ * page it is on and where.
+ */
+class TextureAtlas {
+public:
+    /// Largest width and height of an atlas page
+    static const int PageSize = 2048;
+
+    /// Border around each image in the atlas
+    static const int Padding = 2;
+
+    /// Constructor (disabled)
+    TextureAtlas() = delete;
+
+    static std::vector<std::shared_ptr<CachedImage>> Pack(const std::vector<std::shared_ptr<CachedImage>>& images);
+};
+
+}
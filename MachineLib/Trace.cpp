@@ -0,0 +1,347 @@
+/**
+ * @file Trace.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    /// One event in the ring buffer.
+    ///
+    /// The sequence is odd while the event is being written and
+    /// even once it is complete, so a dump running at the same
+    /// time as a recording thread skips half written events.
+    struct Slot
+    {
+        /// Twice the index of the event written, plus one while writing
+        std::atomic<uint64_t> mSequence{0};
+
+        /// Category of the event
+        std::atomic<const char*> mCategory{nullptr};
+
+        /// Name of the event
+        std::atomic<const char*> mName{nullptr};
+
+        /// Is the name a type name?
+        std::atomic<bool> mTypeName{false};
+
+        /// Thread that recorded the event
+        std::atomic<uint32_t> mThread{0};
+
+        /// Start time in nanoseconds
+        std::atomic<uint64_t> mStart{0};
+
+        /// End time in nanoseconds
+        std::atomic<uint64_t> mEnd{0};
+    };
+
+    /// The ring buffer of events
+    struct Buffer
+    {
+        /// Index of the next event to write
+        std::atomic<uint64_t> mNext{0};
+
+        /// The events
+        std::unique_ptr<Slot[]> mSlots = std::make_unique<Slot[]>(Trace::Capacity);
+    };
+
+    /// File to write the trace to at exit
+    std::string ExitFilename;
+
+    /// Protects ExitFilename
+    std::mutex ExitMutex;
+
+    /**
+     * Write the trace to the exit file
+     */
+    void DumpOnExit()
+    {
+        std::lock_guard<std::mutex> lock(ExitMutex);
+        if(!ExitFilename.empty())
+        {
+            Trace::Dump(ExitFilename);
+        }
+    }
+
+    /**
+     * Get the ring buffer, creating it on first use
+     * @return Ring buffer
+     */
+    Buffer& GetBuffer()
+    {
+        static Buffer* buffer = []() {
+            auto filename = std::getenv("MACHINELIB_TRACE_FILE");
+            if(filename != nullptr && *filename != 0)
+            {
+                Trace::DumpAtExit(filename);
+            }
+
+            // Never freed, so threads still recording
+            // while the program exits are safe
+            return new Buffer();
+        }();
+
+        return *buffer;
+    }
+
+    /**
+     * Get a small number identifying the calling thread
+     * @return Thread number
+     */
+    uint32_t GetThread()
+    {
+        static std::atomic<uint32_t> next(1);
+        thread_local uint32_t thread = next++;
+        return thread;
+    }
+
+    /**
+     * Get a readable name for a type
+     * @param name Type name from std::type_info
+     * @return Readable name
+     */
+    std::string Demangle(const char* name)
+    {
+        std::string result = name;
+#ifdef __GNUG__
+        int status = 0;
+        auto demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if(status == 0 && demangled != nullptr)
+        {
+            result = demangled;
+        }
+        std::free(demangled);
+#else
+        for(auto prefix : {"class ", "struct "})
+        {
+            if(result.rfind(prefix, 0) == 0)
+            {
+                result = result.substr(std::strlen(prefix));
+            }
+        }
+#endif
+        return result;
+    }
+
+    /**
+     * Write a string as a JSON string
+     * @param out Stream to write to
+     * @param text String to write
+     */
+    void WriteString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for(auto c : text)
+        {
+            if(c == '"' || c == '\\')
+            {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+/**
+ * Constructor, starts timing
+ * @param category Category of the event, must outlive the trace
+ * @param name Name of the event, must outlive the trace
+ * @param typeName Is name a type name from std::type_info?
+ */
+Trace::Scope::Scope(const char* category, const char* name, bool typeName) :
+    mCategory(category), mName(name), mTypeName(typeName), mStart(Now())
+{
+}
+
+/**
+ * Destructor, records the event
+ */
+Trace::Scope::~Scope()
+{
+    Record(mCategory, mName, mTypeName, mStart, Now());
+}
+
+/**
+ * Get the current time for an event
+ * @return Nanoseconds since some fixed time
+ */
+uint64_t Trace::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Record an event
+ * @param category Category of the event, must outlive the trace
+ * @param name Name of the event, must outlive the trace
+ * @param typeName Is name a type name from std::type_info?
+ * @param start Start time from Now
+ * @param end End time from Now
+ */
+void Trace::Record(const char* category, const char* name, bool typeName, uint64_t start, uint64_t end)
+{
+    auto& buffer = GetBuffer();
+    auto index = buffer.mNext.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = buffer.mSlots[index & (Capacity - 1)];
+
+    slot.mSequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.mCategory.store(category, std::memory_order_relaxed);
+    slot.mName.store(name, std::memory_order_relaxed);
+    slot.mTypeName.store(typeName, std::memory_order_relaxed);
+    slot.mThread.store(GetThread(), std::memory_order_relaxed);
+    slot.mStart.store(start, std::memory_order_relaxed);
+    slot.mEnd.store(end, std::memory_order_relaxed);
+
+    slot.mSequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+/**
+ * Write the events in the buffer as Chrome trace JSON.
+ *
+ * Times are in microseconds from the earliest event.
+ * @param out Stream to write to
+ */
+void Trace::Dump(std::ostream& out)
+{
+    // A complete copy of an event
+    struct Event
+    {
+        /// Category of the event
+        const char* mCategory;
+
+        /// Name of the event
+        const char* mName;
+
+        /// Is the name a type name?
+        bool mTypeName;
+
+        /// Thread that recorded the event
+        uint32_t mThread;
+
+        /// Start time in nanoseconds
+        uint64_t mStart;
+
+        /// End time in nanoseconds
+        uint64_t mEnd;
+    };
+
+    auto& buffer = GetBuffer();
+    auto next = buffer.mNext.load(std::memory_order_acquire);
+    auto first = next > Capacity ? next - Capacity : 0;
+
+    std::vector<Event> events;
+    for(auto index = first; index < next; index++)
+    {
+        auto& slot = buffer.mSlots[index & (Capacity - 1)];
+
+        auto sequence = slot.mSequence.load(std::memory_order_acquire);
+        if(sequence != index * 2 + 2)
+        {
+            continue;
+        }
+
+        Event event;
+        event.mCategory = slot.mCategory.load(std::memory_order_relaxed);
+        event.mName = slot.mName.load(std::memory_order_relaxed);
+        event.mTypeName = slot.mTypeName.load(std::memory_order_relaxed);
+        event.mThread = slot.mThread.load(std::memory_order_relaxed);
+        event.mStart = slot.mStart.load(std::memory_order_relaxed);
+        event.mEnd = slot.mEnd.load(std::memory_order_relaxed);
+
+        // Overwritten while we were reading it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.mSequence.load(std::memory_order_relaxed) == sequence)
+        {
+            events.push_back(event);
+        }
+    }
+
+    // Events are recorded when they end, so the
+    // earliest start is not always the first event
+    uint64_t origin = events.empty() ? 0 : events[0].mStart;
+    for(auto& event : events)
+    {
+        origin = std::min(origin, event.mStart);
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for(size_t i=0; i<events.size(); i++)
+    {
+        auto& event = events[i];
+        out << (i > 0 ? ",\n" : "\n") << "{\"name\":";
+        WriteString(out, event.mTypeName ? Demangle(event.mName) : std::string(event.mName));
+        out << ",\"cat\":";
+        WriteString(out, event.mCategory);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.mThread
+            << ",\"ts\":" << double(event.mStart - origin) / 1000.0
+            << ",\"dur\":" << double(event.mEnd - event.mStart) / 1000.0 << "}";
+    }
+
+    out << "\n]}\n";
+}
+
+/**
+ * Write the events in the buffer to a Chrome trace JSON file
+ * @param filename File to write
+ * @return true if successful
+ */
+bool Trace::Dump(const std::string& filename)
+{
+    std::ofstream file(filename);
+    if(!file)
+    {
+        return false;
+    }
+
+    Dump(file);
+    return file.good();
+}
+
+/**
+ * Write the trace to a file when the program exits
+ * @param filename File to write
+ */
+void Trace::DumpAtExit(const std::string& filename)
+{
+    static std::once_flag registered;
+    std::call_once(registered, []() {std::atexit(DumpOnExit);});
+
+    std::lock_guard<std::mutex> lock(ExitMutex);
+    ExitFilename = filename;
+}
+
+/**
+ * Throw away every event recorded so far.
+ *
+ * Only call while no other thread is recording.
+ */
+void Trace::Clear()
+{
+    auto& buffer = GetBuffer();
+    for(size_t i=0; i<Capacity; i++)
+    {
+        buffer.mSlots[i].mSequence.store(0, std::memory_order_relaxed);
+    }
+
+    buffer.mNext.store(0, std::memory_order_release);
+}
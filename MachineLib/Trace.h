@@ -0,0 +1,111 @@
+/**
+ * @file Trace.h
+ * @author Max Tetlow
+ *
+ * Scoped timing events that can be viewed in
+ * chrome://tracing or the Perfetto UI.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_TRACE_H
+#define CANADIANEXPERIENCE_MACHINELIB_TRACE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+/**
+ * Scoped timing events that can be viewed in
+ * chrome://tracing or the Perfetto UI.
+ *
+ * Events are recorded with the MACHINE_TRACE and MACHINE_TRACE_TYPE
+ * macros, which time the rest of the enclosing scope. The macros
+ * compile to nothing unless the library is built with the CMake
+ * option MACHINELIB_TRACE.
+ *
+ * Events go into a fixed size ring buffer. Any thread can record
+ * without taking a lock, and once the buffer is full the oldest
+ * events are overwritten. Dump writes the events in the buffer as
+ * Chrome trace JSON. If the environment variable MACHINELIB_TRACE_FILE
+ * is set when the first event is recorded, the trace is also written
+ * to that file when the program exits.
+ */
+class Trace
+{
+public:
+    /// Number of events the ring buffer holds, a power of two
+    static const size_t Capacity = 1 << 16;
+
+    /**
+     * Times the scope it is declared in
+     */
+    class Scope
+    {
+    private:
+        /// Category of the event
+        const char* mCategory;
+
+        /// Name of the event, or a type name to demangle
+        const char* mName;
+
+        /// Is mName a type name?
+        bool mTypeName;
+
+        /// Start time in nanoseconds
+        uint64_t mStart;
+
+    public:
+        Scope(const char* category, const char* name, bool typeName = false);
+
+        ~Scope();
+
+        /// Copy constructor (disabled)
+        Scope(const Scope &) = delete;
+
+        /// Assignment operator
+        void operator=(const Scope &) = delete;
+    };
+
+    /// Constructor (disabled)
+    Trace() = delete;
+
+    static uint64_t Now();
+
+    static void Record(const char* category, const char* name, bool typeName, uint64_t start, uint64_t end);
+
+    static void Dump(std::ostream& out);
+
+    static bool Dump(const std::string& filename);
+
+    static void DumpAtExit(const std::string& filename);
+
+    static void Clear();
+};
+
+#ifdef MACHINELIB_TRACE
+
+/// Paste two tokens together after expanding them
+#define MACHINE_TRACE_CONCAT2(a, b) a##b
+
+/// Paste two tokens together after expanding them
+#define MACHINE_TRACE_CONCAT(a, b) MACHINE_TRACE_CONCAT2(a, b)
+
+/// Time the rest of the scope as an event with a category and name
+#define MACHINE_TRACE(category, name) \
+    Trace::Scope MACHINE_TRACE_CONCAT(traceScope, __LINE__)(category, name)
+
+/// Time the rest of the scope as an event named for the type of an object
+#define MACHINE_TRACE_TYPE(category, object) \
+    Trace::Scope MACHINE_TRACE_CONCAT(traceScope, __LINE__)(category, typeid(object).name(), true)
+
+#else
+
+/// Tracing is disabled
+#define MACHINE_TRACE(category, name)
+
+/// Tracing is disabled
+#define MACHINE_TRACE_TYPE(category, object)
+
+#endif
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_TRACE_H
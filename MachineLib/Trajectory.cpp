@@ -0,0 +1,176 @@
+/**
+ * @file Trajectory.cpp
+ * @author Max Tetlow
+ */
+
+#include "pch.h"
+#include "Trajectory.h"
+#include "Machine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <b2_body.h>
+#include <b2_world.h>
+
+/// Identifies a trajectory file
+const char TrajectoryMagic[4] = {'M', 'T', 'R', 'C'};
+
+/// Trajectory file format version
+const std::uint32_t TrajectoryVersion = 1;
+
+/**
+ * Constructor
+ * @param machine Machine number being recorded
+ * @param rate Frame rate the machine is run at
+ */
+Trajectory::Trajectory(int machine, double rate) : mMachineNumber(machine), mFrameRate(rate)
+{
+}
+
+/**
+ * Record the transform of every body for the current frame
+ * @param machine Machine to record
+ */
+void Trajectory::Record(Machine* machine)
+{
+    auto& bodies = machine->GetBodies();
+    if(mValues.empty())
+    {
+        mBodyCount = int(bodies.size());
+    }
+
+    for(auto body : bodies)
+    {
+        auto position = body->GetPosition();
+        mValues.push_back(position.x);
+        mValues.push_back(position.y);
+        mValues.push_back(body->GetAngle());
+    }
+}
+
+/**
+ * Save the trajectory to a binary file
+ * @param filename File to write
+ * @return true if successful
+ */
+bool Trajectory::Save(const std::string& filename)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+
+    std::int32_t machine = mMachineNumber;
+    std::int32_t bodies = mBodyCount;
+    std::uint64_t count = mValues.size();
+
+    file.write(TrajectoryMagic, sizeof(TrajectoryMagic));
+    file.write((const char*)&TrajectoryVersion, sizeof(TrajectoryVersion));
+    file.write((const char*)&machine, sizeof(machine));
+    file.write((const char*)&mFrameRate, sizeof(mFrameRate));
+    file.write((const char*)&bodies, sizeof(bodies));
+    file.write((const char*)&count, sizeof(count));
+    file.write((const char*)mValues.data(), count * sizeof(float));
+
+    return bool(file);
+}
+
+/**
+ * Load a trajectory from a binary file
+ * @param filename File to read
+ * @return true if successful
+ */
+bool Trajectory::Load(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if(!file)
+    {
+        return false;
+    }
+
+    char magic[sizeof(TrajectoryMagic)];
+    std::uint32_t version = 0;
+    std::int32_t machine = 0;
+    std::int32_t bodies = 0;
+    std::uint64_t count = 0;
+
+    file.read(magic, sizeof(magic));
+    file.read((char*)&version, sizeof(version));
+    if(!file || std::memcmp(magic, TrajectoryMagic, sizeof(magic)) != 0 || version != TrajectoryVersion)
+    {
+        return false;
+    }
+
+    file.read((char*)&machine, sizeof(machine));
+    file.read((char*)&mFrameRate, sizeof(mFrameRate));
+    file.read((char*)&bodies, sizeof(bodies));
+    file.read((char*)&count, sizeof(count));
+    if(!file)
+    {
+        return false;
+    }
+
+    mMachineNumber = machine;
+    mBodyCount = bodies;
+    mValues.resize(count);
+    file.read((char*)mValues.data(), count * sizeof(float));
+
+    return bool(file);
+}
+
+/**
+ * Compare this trajectory to another one
+ * @param other Trajectory to compare to
+ * @param tolerance Largest difference in position (meters)
+ * or angle (radians) that is not a divergence
+ * @param divergence Set to where the trajectories first diverge
+ * @return true if the trajectories match within the tolerance
+ */
+bool Trajectory::Compare(const Trajectory& other, double tolerance, Divergence& divergence) const
+{
+    if(mBodyCount != other.mBodyCount)
+    {
+        // Different machines entirely
+        divergence.mFrame = 1;
+        divergence.mBody = std::min(mBodyCount, other.mBodyCount);
+        divergence.mError = INFINITY;
+        return false;
+    }
+
+    auto frames = std::min(GetFrameCount(), other.GetFrameCount());
+    size_t index = 0;
+    for(int frame=0; frame<frames; frame++)
+    {
+        for(int body=0; body<mBodyCount; body++, index += 3)
+        {
+            double error = 0;
+            for(int i=0; i<3; i++)
+            {
+                error = std::max(error, (double)std::abs(mValues[index + i] - other.mValues[index + i]));
+            }
+
+            if(!(error <= tolerance))
+            {
+                divergence.mFrame = frame + 1;
+                divergence.mBody = body;
+                divergence.mError = error;
+                return false;
+            }
+        }
+    }
+
+    if(GetFrameCount() != other.GetFrameCount())
+    {
+        // One run is longer than the other
+        divergence.mFrame = frames + 1;
+        divergence.mBody = 0;
+        divergence.mError = INFINITY;
+        return false;
+    }
+
+    return true;
+}
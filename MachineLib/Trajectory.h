@@ -0,0 +1,89 @@
+/**
+ * @file Trajectory.h
+ * @author Max Tetlow
+ *
+ * Recording of every body transform for every frame of
+ * a machine run, used to detect changes in behavior.
+ */
+
+#ifndef CANADIANEXPERIENCE_MACHINELIB_TRAJECTORY_H
+#define CANADIANEXPERIENCE_MACHINELIB_TRAJECTORY_H
+
+#include <string>
+#include <vector>
+
+class Machine;
+
+/**
+ * Recording of every body transform for every frame of
+ * a machine run, used to detect changes in behavior.
+ *
+ * A golden trajectory is recorded once and saved in a compact
+ * binary file. Later runs are recorded the same way and compared
+ * to it to find the first frame and body where they diverge.
+ */
+class Trajectory
+{
+private:
+    /// Machine number that was run
+    int mMachineNumber = 1;
+
+    /// Frame rate the machine was run at
+    double mFrameRate = 30;
+
+    /// Number of bodies in each frame
+    int mBodyCount = 0;
+
+    /// x, y, angle for each body of each frame, in meters and radians
+    std::vector<float> mValues;
+
+public:
+    /// Where two trajectories first differ
+    struct Divergence
+    {
+        /// Frame number, starting at 1 for the first recorded frame
+        int mFrame = 0;
+
+        /// Body index in the physics world body list
+        int mBody = 0;
+
+        /// Largest difference in position (meters) or angle (radians)
+        double mError = 0;
+    };
+
+    Trajectory(int machine, double rate);
+
+    /// Copy constructor (disabled)
+    Trajectory(const Trajectory &) = delete;
+
+    /// Assignment operator
+    void operator=(const Trajectory &) = delete;
+
+    void Record(Machine* machine);
+
+    bool Save(const std::string& filename);
+
+    bool Load(const std::string& filename);
+
+    bool Compare(const Trajectory& other, double tolerance, Divergence& divergence) const;
+
+    /**
+     * Get the number of frames recorded
+     * @return Number of frames
+     */
+    int GetFrameCount() const {return mBodyCount == 0 ? 0 : int(mValues.size() / (mBodyCount * 3));}
+
+    /**
+     * Get the machine number that was run
+     * @return Machine number
+     */
+    int GetMachineNumber() const {return mMachineNumber;}
+
+    /**
+     * Get the frame rate the machine was run at
+     * @return Frame rate in frames per second
+     */
+    double GetFrameRate() const {return mFrameRate;}
+};
+
+#endif //CANADIANEXPERIENCE_MACHINELIB_TRAJECTORY_H
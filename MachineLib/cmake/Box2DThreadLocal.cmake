@@ -0,0 +1,20 @@
+#
+# Patch step for the Box2D sources, run by FetchContent in
+# the Box2D source directory.
+#
+# Box2D counts GJK and time of impact calls in global variables
+# that every b2World::Step updates. Region worlds are stepped on
+# several threads at once, so each thread gets its own counters.
+#
+
+foreach(source
+        include/box2d/b2_distance.h
+        include/box2d/b2_time_of_impact.h
+        src/collision/b2_distance.cpp
+        src/collision/b2_time_of_impact.cpp)
+    file(READ ${source} contents)
+    if(NOT contents MATCHES "thread_local")
+        string(REGEX REPLACE "(int32|float)( b2_(gjk|toi))" "thread_local \\1\\2" contents "${contents}")
+        file(WRITE ${source} "${contents}")
+    endif()
+endforeach()
@@ -0,0 +1,192 @@
+/**
+ * @file DispatchBenchmarks.cpp
+ * @author Max Tetlow
+ *
+ * Benchmarks for contact listener dispatch and rotation
+ * propagation.
+ */
+
+#include "pch.h"
+
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <b2_body.h>
+#include <b2_contact.h>
+#include <b2_fixture.h>
+#include <b2_polygon_shape.h>
+#include <b2_world.h>
+
+#include <ContactListener.h>
+#include <RotationSource.h>
+#include <Body.h>
+#include <Hamster.h>
+#include <Pulley.h>
+#include <ComponentStore.h>
+#include <RotationGraph.h>
+
+#include "Resources.h"
+
+/**
+ * A listener that does nothing, so only the
+ * dispatch itself is timed.
+ */
+class NullListener : public b2ContactListener
+{
+public:
+    /**
+     * Handle before the solution of a contact
+     * @param contact Contact object
+     * @param oldManifold Manifold object
+     */
+    void PreSolve(b2Contact *contact, const b2Manifold *oldManifold) override
+    {
+        benchmark::DoNotOptimize(contact);
+    }
+};
+
+/**
+ * Time ContactListener::PreSolve over a row of boxes resting on a floor.
+ *
+ * range(0) is the number of boxes, range(1) is 1 if the floor has
+ * a listener installed or 0 if no body does, which is the
+ * domino-domino case.
+ * @param state Benchmark state
+ */
+static void BM_ContactDispatch(benchmark::State& state)
+{
+    b2World world(b2Vec2(0, -9.8f));
+
+    b2BodyDef floorDefinition;
+    auto floor = world.CreateBody(&floorDefinition);
+    b2PolygonShape floorShape;
+    floorShape.SetAsBox(100, 0.1f);
+    floor->CreateFixture(&floorShape, 0);
+
+    int count = (int)state.range(0);
+    for(int i=0; i<count; i++)
+    {
+        b2BodyDef boxDefinition;
+        boxDefinition.type = b2_dynamicBody;
+        boxDefinition.position.Set(-count * 0.1f + i * 0.2f, 0.2f);
+        auto box = world.CreateBody(&boxDefinition);
+        b2PolygonShape boxShape;
+        boxShape.SetAsBox(0.11f, 0.1f);
+        box->CreateFixture(&boxShape, 1);
+    }
+
+    // Let everything settle so the contacts exist
+    for(int i=0; i<60; i++)
+    {
+        world.Step(1.0f / 30, 6, 2);
+    }
+
+    std::vector<b2Contact*> contacts;
+    for(auto contact = world.GetContactList(); contact != nullptr; contact = contact->GetNext())
+    {
+        contacts.push_back(contact);
+    }
+
+    ContactListener listener;
+    NullListener nullListener;
+    if(state.range(1) != 0)
+    {
+        listener.Add(floor, &nullListener);
+    }
+
+    for(auto _ : state)
+    {
+        for(auto contact : contacts)
+        {
+            listener.PreSolve(contact, nullptr);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * contacts.size());
+}
+
+BENCHMARK(BM_ContactDispatch)->ArgsProduct({{16, 256}, {0, 1}});
+
+/**
+ * Time RotationSource::SetRotation driving some number of sinks
+ * @param state Benchmark state, range(0) is the number of sinks
+ */
+static void BM_RotationFanOut(benchmark::State& state)
+{
+    auto world = std::make_shared<b2World>(b2Vec2(0, -9.8f));
+
+    RotationSource source(nullptr);
+    std::vector<std::shared_ptr<Body>> sinks;
+    for(int i=0; i<state.range(0); i++)
+    {
+        auto body = std::make_shared<Body>();
+        body->GetPolygon()->Rectangle(-5, -5, 10, 10);
+        body->GetPolygon()->SetColor(*wxBLACK);
+        body->GetPolygon()->SetInitialPosition(i * 20, 0);
+        body->GetPolygon()->SetKinematic();
+        body->SetPhysic(nullptr, world);
+        source.AddSink(body);
+        sinks.push_back(body);
+    }
+
+    double rotation = 0;
+    for(auto _ : state)
+    {
+        source.SetRotation(rotation, 0.5);
+        rotation += 0.01;
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_RotationFanOut)->RangeMultiplier(4)->Range(1, 256);
+
+/**
+ * Time propagating a hamster's rotation down a train of
+ * pulleys, each driving the next with a belt
+ * @param state Benchmark state, range(0) is the number of pulleys
+ * and range(1) is 1 to use a compiled RotationGraph
+ */
+static void BM_PulleyTrain(benchmark::State& state)
+{
+    ComponentStore components;
+
+    auto hamster = std::make_shared<Hamster>(ResourcesDir + L"/images");
+    components.Add(hamster);
+
+    std::shared_ptr<Pulley> previous;
+    for(int i=0; i<state.range(0); i++)
+    {
+        auto pulley = std::make_shared<Pulley>(10);
+        components.Add(pulley);
+        if(previous == nullptr)
+        {
+            hamster->GetSource()->AddSink(pulley);
+        }
+        else
+        {
+            previous->Drive(pulley);
+        }
+        previous = pulley;
+    }
+
+    RotationGraph graph;
+    if(state.range(1))
+    {
+        graph.Compile(components);
+    }
+
+    double rotation = 0;
+    for(auto _ : state)
+    {
+        hamster->GetSource()->SetRotation(rotation, 0.5);
+        if(state.range(1))
+        {
+            graph.Propagate();
+        }
+        rotation += 0.01;
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PulleyTrain)->ArgsProduct({{1, 16, 256}, {0, 1}});
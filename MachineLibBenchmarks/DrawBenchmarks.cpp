@@ -0,0 +1,181 @@
+/**
+ * @file DrawBenchmarks.cpp
+ * @author Max Tetlow
+ *
+ * Benchmarks for drawing polygons on an offscreen graphics context.
+ */
+
+#include "pch.h"
+
+#include <benchmark/benchmark.h>
+
+#include <Polygon.h>
+#include <Machine.h>
+#include <MachineFactory.h>
+
+#include "Resources.h"
+
+using namespace cse335;
+
+/// Size of the offscreen image we draw on
+const wxSize OffscreenSize = wxSize(1024, 768);
+
+/**
+ * Time drawing a color filled domino
+ * @param state Benchmark state
+ */
+static void BM_DrawColorPolygon(benchmark::State& state)
+{
+    wxImage image(OffscreenSize);
+    std::shared_ptr<wxGraphicsContext> graphics(wxGraphicsContext::Create(image));
+
+    // No atlas left packed by an earlier benchmark
+    ImageCache::Clear();
+
+    Polygon polygon;
+    polygon.Rectangle(-2.5, -12.5, 5, 25);
+    polygon.SetColor(*wxGREEN);
+
+    double rotation = 0;
+    for(auto _ : state)
+    {
+        polygon.DrawPolygon(graphics, 512, 384, rotation);
+        rotation += 0.01;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DrawColorPolygon);
+
+/**
+ * Time drawing an image mapped domino
+ * @param state Benchmark state
+ */
+static void BM_DrawImagePolygon(benchmark::State& state)
+{
+    wxImage image(OffscreenSize);
+    std::shared_ptr<wxGraphicsContext> graphics(wxGraphicsContext::Create(image));
+
+    // The image is drawn on its own, not from an atlas
+    // left packed by an earlier benchmark
+    ImageCache::Clear();
+
+    Polygon polygon;
+    polygon.Rectangle(-2.5, -12.5, 5, 25);
+    polygon.SetImage(ResourcesDir + L"/images/domino-green.png");
+
+    double rotation = 0;
+    for(auto _ : state)
+    {
+        polygon.DrawPolygon(graphics, 512, 384, rotation);
+        rotation += 0.01;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DrawImagePolygon);
+
+/**
+ * Time drawing an image mapped domino whose
+ * image has been packed into a texture atlas
+ * @param state Benchmark state
+ */
+static void BM_DrawAtlasPolygon(benchmark::State& state)
+{
+    wxImage image(OffscreenSize);
+    std::shared_ptr<wxGraphicsContext> graphics(wxGraphicsContext::Create(image));
+
+    ImageCache::Clear();
+    ImageCache::LoadAtlas(ResourcesDir + L"/images");
+
+    Polygon polygon;
+    polygon.Rectangle(-2.5, -12.5, 5, 25);
+    polygon.SetImage(ResourcesDir + L"/images/domino-green.png");
+
+    double rotation = 0;
+    for(auto _ : state)
+    {
+        polygon.DrawPolygon(graphics, 512, 384, rotation);
+        rotation += 0.01;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    ImageCache::Clear();
+}
+
+BENCHMARK(BM_DrawAtlasPolygon);
+
+/**
+ * Time building the dominoes and balls of a large machine,
+ * up to the point their shapes are shared through ShapeCache
+ * @param state Benchmark state, range(0) is the number of dominoes and balls
+ */
+static void BM_CreatePolygons(benchmark::State& state)
+{
+    auto count = (int)state.range(0);
+    for(auto _ : state)
+    {
+        std::vector<std::unique_ptr<Polygon>> polygons;
+        polygons.reserve(count * 2);
+        for(int i=0; i<count; i++)
+        {
+            auto domino = std::make_unique<Polygon>();
+            domino->Rectangle(-2.5, -12.5, 5, 25);
+            domino->BoundingBox();
+            polygons.push_back(std::move(domino));
+
+            auto ball = std::make_unique<Polygon>();
+            ball->Circle(6);
+            ball->BoundingBox();
+            polygons.push_back(std::move(ball));
+        }
+
+        benchmark::DoNotOptimize(polygons.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count * 2);
+}
+
+BENCHMARK(BM_CreatePolygons)->Arg(1000)->Arg(10000);
+
+/**
+ * Time drawing a whole machine a frame at a time
+ * @param state Benchmark state, range(0) is the machine number and
+ * range(1) is 0 to advance the machine every frame or 1 to let the
+ * machine come to rest first and draw it without advancing
+ */
+static void BM_DrawMachine(benchmark::State& state)
+{
+    wxImage image(OffscreenSize);
+    std::shared_ptr<wxGraphicsContext> graphics(wxGraphicsContext::Create(image));
+    graphics->Translate(512, 700);
+    graphics->Scale(1.5, -1.5);
+
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+    machine->Reset();
+
+    auto idle = state.range(1) != 0;
+    if(idle)
+    {
+        machine->Advance(20);
+    }
+
+    for(auto _ : state)
+    {
+        if(!idle)
+        {
+            machine->Advance(1.0 / 30.0);
+        }
+
+        machine->Draw(graphics);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_DrawMachine)->ArgsProduct({{1, 2}, {0, 1}});
@@ -0,0 +1,291 @@
+/**
+ * @file MachineBenchmarks.cpp
+ * @author Max Tetlow
+ *
+ * Benchmarks for stepping, resetting, loading and building machines.
+ */
+
+#include "pch.h"
+
+#include <benchmark/benchmark.h>
+
+#include <Machine.h>
+#include <MachineFactory.h>
+#include <ActualMachineSystem.h>
+#include <ImageCache.h>
+#include <MachineDescription.h>
+#include <ParameterSweep.h>
+
+#include <wx/filename.h>
+#include <b2_world.h>
+
+using namespace cse335;
+
+#include "Resources.h"
+
+/// Frame rate the machines are stepped at
+const double FrameRate = 30;
+
+/// Physics steps to run before a machine is reset so the
+/// benchmark covers the whole animation, not just the end
+const int StepsPerRun = 900;
+
+/**
+ * Time one Machine::Update physics step
+ * @param state Benchmark state, range(0) is the machine number
+ */
+static void BM_MachineUpdate(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+
+    int step = 0;
+    for(auto _ : state)
+    {
+        machine->Update(Machine::PhysicsStep);
+
+        if(++step == StepsPerRun)
+        {
+            state.PauseTiming();
+            machine->Reset();
+            step = 0;
+            state.ResumeTiming();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MachineUpdate)->Arg(1)->Arg(2);
+
+/**
+ * Time one Machine::Update physics step of a generated
+ * stress machine after it has run for a second, so the
+ * dominoes and balls are in motion
+ * @param state Benchmark state, range(0) is the number of bodies
+ */
+static void BM_StressUpdate(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+    machine->Advance(1.0);
+
+    for(auto _ : state)
+    {
+        machine->Update(Machine::PhysicsStep);
+    }
+
+    state.counters["bodies"] = double(machine->GetBodies().size());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_StressUpdate)->RangeMultiplier(2)->Range(1000, 16000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Time one Machine::Update physics step of a generated
+ * stress machine split into regions stepped on threads
+ * @param state Benchmark state, range(0) is the number of
+ * bodies and range(1) the number of threads
+ */
+static void BM_StressUpdateRegions(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+    machine->SetThreads((int)state.range(1));
+    machine->Reset();
+    machine->Advance(1.0);
+
+    for(auto _ : state)
+    {
+        machine->Update(Machine::PhysicsStep);
+    }
+
+    state.counters["bodies"] = double(machine->GetBodies().size());
+    state.counters["regions"] = double(machine->GetRegionCount());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_StressUpdateRegions)->ArgsProduct({{4000, 16000}, {1, 2, 4, 8}})->Unit(benchmark::kMillisecond);
+
+/**
+ * Time Machine::Reset after the machine has run
+ * @param state Benchmark state, range(0) is the machine number
+ */
+static void BM_MachineReset(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        for(int i=0; i<30; i++)
+        {
+            machine->Advance(1.0 / FrameRate);
+        }
+        state.ResumeTiming();
+
+        machine->Reset();
+    }
+}
+
+BENCHMARK(BM_MachineReset)->Arg(1)->Arg(2);
+
+/**
+ * Time building the physics world of a machine again,
+ * which is what Reset did before it restored in place
+ * @param state Benchmark state
+ */
+static void BM_MachineRebuild(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+
+    for(auto _ : state)
+    {
+        machine->Rebuild();
+    }
+}
+
+BENCHMARK(BM_MachineRebuild)->Arg(1)->Arg(2);
+
+/**
+ * Time building a machine when none of the images are cached.
+ *
+ * This is the work of packing the images into the atlas, done
+ * once at startup, and then building the machine, which
+ * ActualMachineSystem::SetMachineNumber does on its worker thread.
+ * @param state Benchmark state, range(0) is the machine number
+ */
+static void BM_SetMachineNumberCold(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        ImageCache::Clear();
+        state.ResumeTiming();
+
+        factory.LoadImages();
+        benchmark::DoNotOptimize(factory.Create((int)state.range(0)));
+    }
+}
+
+BENCHMARK(BM_SetMachineNumberCold)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+/**
+ * Time building a machine when all of the images are cached
+ * @param state Benchmark state, range(0) is the machine number
+ */
+static void BM_SetMachineNumberWarm(benchmark::State& state)
+{
+    MachineFactory factory(ResourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create((int)state.range(0));
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(factory.Create((int)state.range(0)));
+    }
+}
+
+BENCHMARK(BM_SetMachineNumberWarm)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+/**
+ * Time ActualMachineSystem::SetMachineNumber switching between
+ * machines once they have been built in the background. This is
+ * the cost the user interface thread sees.
+ * @param state Benchmark state
+ */
+static void BM_SetMachineNumberSwitch(benchmark::State& state)
+{
+    ActualMachineSystem system(ResourcesDir);
+    system.SetFrameRate(FrameRate);
+
+    // Wait for the background build of machine 2
+    system.SetMachineNumber(2);
+    system.WaitForMachine();
+
+    int machine = 1;
+    for(auto _ : state)
+    {
+        system.SetMachineNumber(machine);
+        machine = 3 - machine;
+    }
+}
+
+BENCHMARK(BM_SetMachineNumberSwitch)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Time loading machine 1 from its XML machine file
+ * @param state Benchmark state
+ */
+static void BM_LoadMachineXml(benchmark::State& state)
+{
+    auto filename = ResourcesDir + L"/images/machines/machine1.xml";
+
+    for(auto _ : state)
+    {
+        MachineDescription description;
+        benchmark::DoNotOptimize(description.Load(filename));
+    }
+}
+
+BENCHMARK(BM_LoadMachineXml)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Time loading machine 1 from a compiled machine file
+ * @param state Benchmark state
+ */
+static void BM_LoadMachineCompiled(benchmark::State& state)
+{
+    auto compiled = wxFileName::CreateTempFileName(L"machine").ToStdWstring();
+
+    MachineDescription xml;
+    xml.Load(ResourcesDir + L"/images/machines/machine1.xml");
+    xml.Save(compiled);
+
+    for(auto _ : state)
+    {
+        MachineDescription description;
+        benchmark::DoNotOptimize(description.Load(compiled));
+    }
+
+    wxRemoveFile(compiled);
+}
+
+BENCHMARK(BM_LoadMachineCompiled)->Unit(benchmark::kMicrosecond);
+
+/**
+ * Time a random parameter sweep of machine 1
+ * with the number of threads in the argument.
+ * Runs per second should grow with the threads.
+ * @param state Benchmark state
+ */
+static void BM_ParameterSweep(benchmark::State& state)
+{
+    ParameterSweep sweep(ResourcesDir);
+    sweep.SetMachineNumber(1);
+    sweep.SetDuration(2);
+    sweep.SetThreads((int)state.range(0));
+    sweep.SetFriction({0.5, 1.5, 1});
+    sweep.SetSpeed({0.5, 2, 1});
+
+    const int Runs = 32;
+    sweep.SetRandom(Runs, 1);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(sweep.Run());
+    }
+
+    state.SetItemsProcessed(state.iterations() * Runs);
+}
+
+BENCHMARK(BM_ParameterSweep)->RangeMultiplier(2)->Range(1, 8)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,17 @@
+/**
+ * @file Resources.h
+ * @author Max Tetlow
+ *
+ * Where the benchmarks find the machine resources.
+ */
+
+#ifndef MACHINELIBBENCHMARKS_RESOURCES_H
+#define MACHINELIBBENCHMARKS_RESOURCES_H
+
+#include <string>
+
+/// Resources directory containing the images directory.
+/// Set from the command line in main.
+extern std::wstring ResourcesDir;
+
+#endif //MACHINELIBBENCHMARKS_RESOURCES_H
@@ -0,0 +1,76 @@
+/**
+ * @file main.cpp
+ * @author Max Tetlow
+ *
+ * Main entry point for the MachineLib benchmarks.
+ */
+
+#include "pch.h"
+
+#include <cstring>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "Resources.h"
+
+/// Resources directory containing the images directory
+std::wstring ResourcesDir = L".";
+
+/**
+ * Main entry point
+ *
+ * Accepts -d to set the resources directory. All other
+ * arguments are passed on to Google Benchmark. Results are
+ * reported as JSON unless another format is requested.
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return 0 if successful
+ */
+int main(int argc, char *argv[])
+{
+    std::vector<char*> args;
+    args.push_back(argv[0]);
+
+    bool format = false;
+    for(int i=1; i<argc; i++)
+    {
+        if(std::strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+        {
+            ResourcesDir = wxString(argv[++i]).ToStdWstring();
+            continue;
+        }
+
+        if(std::strncmp(argv[i], "--benchmark_format", 18) == 0)
+        {
+            format = true;
+        }
+
+        args.push_back(argv[i]);
+    }
+
+    char json[] = "--benchmark_format=json";
+    if(!format)
+    {
+        args.push_back(json);
+    }
+
+    // Only the non-GUI parts of wxWidgets are needed
+    wxInitializer initializer;
+    if(!initializer)
+    {
+        return 1;
+    }
+
+    wxInitAllImageHandlers();
+
+    int count = (int)args.size();
+    benchmark::Initialize(&count, args.data());
+    if(benchmark::ReportUnrecognizedArguments(count, args.data()))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,18 @@
+/**
+ * @file pch.h
+ * @author Max Tetlow
+ */
+
+#ifndef MACHINELIBBENCHMARKS_PCH_H
+#define MACHINELIBBENCHMARKS_PCH_H
+
+#include <wx/wxprec.h>
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <wx/graphics.h>
+
+#define POLYGON_DEFAULT_INVERTEDY
+
+#endif //MACHINELIBBENCHMARKS_PCH_H
@@ -0,0 +1,593 @@
+/**
+ * @file main.cpp
+ * @author Max Tetlow
+ *
+ * Main entry point for the headless machine runner.
+ *
+ * Builds a machine, steps it for some number of frames
+ * without a window and optionally writes the state of every
+ * body for each frame to a file.
+ *
+ * Can also record a golden trajectory and check a new run
+ * against it to find where the behavior changed, compile
+ * XML machine files to their binary form, sweep the
+ * physics parameters of a machine, export its frames
+ * as images and report the memory its polygons use.
+ */
+
+#include "pch.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <HeadlessSimulation.h>
+#include <Trajectory.h>
+#include <FrameExporter.h>
+#include <MachineDescription.h>
+#include <ParameterSweep.h>
+#include <Trace.h>
+#include <Machine.h>
+#include <MachineFactory.h>
+#include <Component.h>
+#include <PhysicsPolygon.h>
+
+#include <wx/filename.h>
+
+/**
+ * Display the command line usage
+ */
+static void Usage()
+{
+    std::cerr << "Usage: MachineRunner [-m machine] [-f frames] [-r rate] [-n runs] [-o file] [-d resources] [--trace file.json]" << std::endl;
+    std::cerr << "                     [--regions threads]" << std::endl;
+    std::cerr << "                     Regions only match a trajectory recorded in one world within a tolerance" << std::endl;
+    std::cerr << "       MachineRunner --record trace [-m machine] [-f frames] [-r rate] [--regions threads] [-d resources]" << std::endl;
+    std::cerr << "       MachineRunner --check trace [-t tolerance] [--regions threads] [--rewind 1] [-d resources]" << std::endl;
+    std::cerr << "       MachineRunner --compile machine.xml" << std::endl;
+    std::cerr << "       MachineRunner --memory machine [-d resources]" << std::endl;
+    std::cerr << "       MachineRunner --export path [--format png|raw] [--size WxH] [-m machine] [-f frames] [-r rate]" << std::endl;
+    std::cerr << "                     [--queue depth] [--regions threads] [-d resources]" << std::endl;
+    std::cerr << "                     Frames show the pose of the last physics step, not interpolated poses" << std::endl;
+    std::cerr << "       MachineRunner --sweep results.csv [-m machine] [-f frames] [-r rate] [-j threads]" << std::endl;
+    std::cerr << "                     [--density min:max:steps] [--friction min:max:steps]" << std::endl;
+    std::cerr << "                     [--restitution min:max:steps] [--speed min:max:steps]" << std::endl;
+    std::cerr << "                     [--random runs] [--seed seed] [-d resources]" << std::endl;
+}
+
+/**
+ * Parse a sweep range from min:max:steps. The steps
+ * and the max can be left off.
+ * @param value Text to parse
+ * @return Range
+ */
+static ParameterSweep::Range ParseRange(const std::string& value)
+{
+    ParameterSweep::Range range;
+
+    auto first = value.find(':');
+    range.mMin = std::stod(value.substr(0, first));
+    range.mMax = range.mMin;
+    if(first != std::string::npos)
+    {
+        auto second = value.find(':', first + 1);
+        range.mMax = std::stod(value.substr(first + 1, second - first - 1));
+        range.mSteps = second != std::string::npos ? std::stoi(value.substr(second + 1)) : 2;
+    }
+
+    return range;
+}
+
+/**
+ * Run a parameter sweep and write the outcomes as CSV
+ * @param sweep Sweep to run
+ * @param filename CSV file to write
+ * @return 0 if successful
+ */
+static int Sweep(ParameterSweep& sweep, const std::string& filename)
+{
+    std::ofstream file(filename);
+    if(!file)
+    {
+        std::cerr << "Unable to open " << filename << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto outcomes = sweep.Run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if(outcomes.empty())
+    {
+        std::cerr << "Nothing to sweep" << std::endl;
+        return 1;
+    }
+
+    ParameterSweep::WriteCsv(file, outcomes);
+
+    int scored = 0;
+    for(auto& outcome : outcomes)
+    {
+        scored += outcome.mScore > 0 ? 1 : 0;
+    }
+
+    std::cout << "runs " << outcomes.size()
+              << " scored " << scored
+              << " seconds " << elapsed.count()
+              << " runs/second " << (elapsed.count() > 0 ? outcomes.size() / elapsed.count() : 0) << std::endl;
+    return 0;
+}
+
+/**
+ * Run a machine again and compare it to a golden trajectory
+ * @param resourcesDir Resources directory
+ * @param filename Golden trajectory file
+ * @param tolerance Largest difference in position (meters)
+ * or angle (radians) that is not a divergence
+ * @param regions Threads to step the machine in regions with, 0 for one world
+ * @param rewind Run the machine once and rewind it with Machine::Reset
+ * before the run that is checked, to compare a replay to a first playback
+ * @return 0 if the run matches, 2 if it diverges, 1 on error
+ */
+static int Check(const std::wstring& resourcesDir, const std::string& filename, double tolerance, int regions, bool rewind)
+{
+    Trajectory golden(1, 30);
+    if(!golden.Load(filename))
+    {
+        std::cerr << "Unable to read trajectory " << filename << std::endl;
+        return 1;
+    }
+
+    HeadlessSimulation simulation(resourcesDir);
+    simulation.SetFrameRate(golden.GetFrameRate());
+    if(!simulation.SetMachineNumber(golden.GetMachineNumber()))
+    {
+        return 1;
+    }
+    if(regions > 0)
+    {
+        simulation.GetMachine()->SetThreads(regions);
+        simulation.Reset();
+    }
+
+    if(rewind)
+    {
+        simulation.Run(golden.GetFrameCount(), nullptr, nullptr);
+        simulation.Reset();
+    }
+
+    Trajectory trajectory(golden.GetMachineNumber(), golden.GetFrameRate());
+    simulation.Run(golden.GetFrameCount(), nullptr, &trajectory);
+
+    Trajectory::Divergence divergence;
+    if(!golden.Compare(trajectory, tolerance, divergence))
+    {
+        std::cout << "diverged at frame " << divergence.mFrame
+                  << " body " << divergence.mBody
+                  << " error " << divergence.mError << std::endl;
+        return 2;
+    }
+
+    std::cout << "matched " << golden.GetFrameCount() << " frames" << std::endl;
+    return 0;
+}
+
+/**
+ * Export frames of a machine and report the time of each stage
+ * @param exporter Exporter with the machine to export
+ * @param frames Number of frames to export
+ * @param path PNG file name prefix or raw file
+ * @param format Format to write the frames in
+ * @return 0 if successful
+ */
+static int Export(FrameExporter& exporter, int frames, const std::string& path, FrameExporter::Format format)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto exported = exporter.Export(frames, path, format);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if(!exported)
+    {
+        std::cerr << "Unable to write " << path << std::endl;
+        return 1;
+    }
+
+    std::cout << "frames " << exporter.GetFramesWritten()
+              << " seconds " << elapsed.count()
+              << " frames/second " << (elapsed.count() > 0 ? exporter.GetFramesWritten() / elapsed.count() : 0)
+              << " simulate " << exporter.GetSimulateSeconds()
+              << " rasterize " << exporter.GetRasterizeSeconds()
+              << " encode " << exporter.GetEncodeSeconds() << std::endl;
+    return 0;
+}
+
+/**
+ * The members of a Polygon up to version 1.10, before mode
+ * specific data was only allocated when used. --memory reports
+ * what the same polygons would use with this layout.
+ */
+struct PolygonLayout110
+{
+    virtual ~PolygonLayout110() = default;
+
+    std::vector<wxPoint2DDouble> mPoints;
+    std::shared_ptr<cse335::PolygonShape> mShape;
+    bool mIsCircle = false;
+    wxBrush mBrush;
+    int mMode = 0;
+    std::shared_ptr<cse335::CachedImage> mImage;
+    wxGraphicsBitmap mGraphicsBitmap;
+    bool mFromAtlas = false;
+    bool mHasDrawn = false;
+    double mOpacity = 1;
+    bool mBitmapDirty = true;
+    bool mInvertedY = false;
+    std::shared_ptr<void> mDelayedMessage;
+};
+
+/**
+ * Build a machine and report the memory its polygons use
+ * @param resourcesDir Resources directory
+ * @param number Machine number, 100 or more for a
+ * generated machine with that many bodies
+ * @return 0 if successful
+ */
+static int Memory(const std::wstring& resourcesDir, int number)
+{
+    MachineFactory factory(resourcesDir);
+    factory.LoadImages();
+    auto machine = factory.Create(number);
+    if(machine == nullptr)
+    {
+        return 1;
+    }
+
+    size_t polygons = 0;
+    size_t objects = 0;
+    size_t heap = 0;
+    size_t oldObjects = 0;
+    size_t oldHeap = 0;
+    for(auto component : machine->GetComponents())
+    {
+        auto polygon = component->GetPolygon();
+        if(polygon == nullptr)
+        {
+            continue;
+        }
+
+        polygons++;
+        auto object = dynamic_cast<cse335::PhysicsPolygon*>(polygon) != nullptr ?
+                      sizeof(cse335::PhysicsPolygon) : sizeof(cse335::Polygon);
+        objects += object;
+        heap += polygon->GetMemoryUsage();
+
+        // The old layout held everything in the object and
+        // only allocated its share of the shape
+        oldObjects += object - sizeof(cse335::Polygon) + sizeof(PolygonLayout110);
+        oldHeap += polygon->GetShapeMemoryUsage();
+    }
+
+    auto perPolygon = [polygons](size_t bytes) {return polygons > 0 ? double(bytes) / polygons : 0.0;};
+    std::cout << "machine " << number
+              << " polygons " << polygons
+              << " shapes " << cse335::ShapeCache::GetCount()
+              << " sizeof(Polygon) " << sizeof(cse335::Polygon)
+              << " sizeof(PhysicsPolygon) " << sizeof(cse335::PhysicsPolygon) << std::endl;
+    std::cout << "bytes/polygon object " << perPolygon(objects)
+              << " heap " << perPolygon(heap)
+              << " total " << perPolygon(objects + heap) << std::endl;
+    std::cout << "1.10 layout bytes/polygon object " << perPolygon(oldObjects)
+              << " heap " << perPolygon(oldHeap)
+              << " total " << perPolygon(oldObjects + oldHeap) << std::endl;
+    return 0;
+}
+
+/**
+ * Compile an XML machine file into a binary machine file
+ * with the same name and the extension .mmc
+ * @param filename XML machine file
+ * @return 0 if successful
+ */
+static int Compile(const std::string& filename)
+{
+    MachineDescription description;
+    if(!description.Load(wxString(filename).ToStdWstring()))
+    {
+        std::cerr << "Unable to read machine file " << filename << std::endl;
+        return 1;
+    }
+
+    wxFileName compiled(filename);
+    compiled.SetExt(L"mmc");
+    if(!description.Save(compiled.GetFullPath().ToStdWstring()))
+    {
+        std::cerr << "Unable to write " << compiled.GetFullPath() << std::endl;
+        return 1;
+    }
+
+    std::cout << "machine " << description.GetMachineNumber()
+              << " components " << description.GetComponentCount()
+              << " written to " << compiled.GetFullPath() << std::endl;
+    return 0;
+}
+
+/**
+ * Main entry point
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return 0 if successful
+ */
+int main(int argc, char *argv[])
+{
+    int machine = 1;
+    int frames = 600;
+    double rate = 30;
+    int runs = 1;
+    std::string output;
+    std::string record;
+    std::string check;
+    std::string compile;
+    std::string sweep;
+    std::string trace;
+    std::string exportPath;
+    int memory = 0;
+    auto format = FrameExporter::Format::Png;
+    int width = 1280;
+    int height = 720;
+    int queue = 4;
+    double tolerance = 1e-4;
+    std::wstring resourcesDir = L".";
+
+    ParameterSweep::Range density, friction, restitution, speed;
+    int threads = 0;
+    int regions = 0;
+    bool rewind = false;
+    int random = 0;
+    unsigned seed = 1;
+
+    for(int i=1; i<argc; i++)
+    {
+        std::string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            Usage();
+            return 1;
+        }
+
+        std::string value = argv[++i];
+        if(arg == "-m")
+        {
+            machine = std::stoi(value);
+        }
+        else if(arg == "-f")
+        {
+            frames = std::stoi(value);
+        }
+        else if(arg == "-r")
+        {
+            rate = std::stod(value);
+        }
+        else if(arg == "-n")
+        {
+            runs = std::stoi(value);
+        }
+        else if(arg == "-o")
+        {
+            output = value;
+        }
+        else if(arg == "-d")
+        {
+            resourcesDir = wxString(value).ToStdWstring();
+        }
+        else if(arg == "--record")
+        {
+            record = value;
+        }
+        else if(arg == "--check")
+        {
+            check = value;
+        }
+        else if(arg == "--compile")
+        {
+            compile = value;
+        }
+        else if(arg == "-t")
+        {
+            tolerance = std::stod(value);
+        }
+        else if(arg == "--trace")
+        {
+            trace = value;
+        }
+        else if(arg == "--sweep")
+        {
+            sweep = value;
+        }
+        else if(arg == "--density")
+        {
+            density = ParseRange(value);
+        }
+        else if(arg == "--friction")
+        {
+            friction = ParseRange(value);
+        }
+        else if(arg == "--restitution")
+        {
+            restitution = ParseRange(value);
+        }
+        else if(arg == "--speed")
+        {
+            speed = ParseRange(value);
+        }
+        else if(arg == "--random")
+        {
+            random = std::stoi(value);
+        }
+        else if(arg == "--seed")
+        {
+            seed = unsigned(std::stoul(value));
+        }
+        else if(arg == "-j")
+        {
+            threads = std::stoi(value);
+        }
+        else if(arg == "--export")
+        {
+            exportPath = value;
+        }
+        else if(arg == "--format" && (value == "png" || value == "raw"))
+        {
+            format = value == "png" ? FrameExporter::Format::Png : FrameExporter::Format::Raw;
+        }
+        else if(arg == "--size")
+        {
+            auto x = value.find('x');
+            width = std::stoi(value.substr(0, x));
+            height = x != std::string::npos ? std::stoi(value.substr(x + 1)) : width;
+        }
+        else if(arg == "--memory")
+        {
+            memory = std::stoi(value);
+        }
+        else if(arg == "--queue")
+        {
+            queue = std::stoi(value);
+        }
+        else if(arg == "--regions")
+        {
+            regions = std::stoi(value);
+        }
+        else if(arg == "--rewind")
+        {
+            rewind = std::stoi(value) != 0;
+        }
+        else
+        {
+            Usage();
+            return 1;
+        }
+    }
+
+    // Only the non-GUI parts of wxWidgets are needed
+    wxInitializer initializer;
+    if(!initializer)
+    {
+        std::cerr << "Unable to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+
+    wxInitAllImageHandlers();
+
+    if(!trace.empty())
+    {
+        Trace::DumpAtExit(trace);
+    }
+
+    if(!compile.empty())
+    {
+        return Compile(compile);
+    }
+
+    if(!check.empty())
+    {
+        return Check(resourcesDir, check, tolerance, regions, rewind);
+    }
+
+    if(memory > 0)
+    {
+        return Memory(resourcesDir, memory);
+    }
+
+    if(!exportPath.empty())
+    {
+        FrameExporter exporter(resourcesDir);
+        if(!exporter.SetMachineNumber(machine))
+        {
+            return 1;
+        }
+
+        exporter.SetRegions(regions);
+        exporter.SetFrameRate(rate);
+        exporter.SetSize(width, height);
+        exporter.SetQueueDepth(queue);
+        return Export(exporter, frames, exportPath, format);
+    }
+
+    if(!sweep.empty())
+    {
+        ParameterSweep parameterSweep(resourcesDir);
+        parameterSweep.SetMachineNumber(machine);
+        parameterSweep.SetDuration(frames / rate);
+        parameterSweep.SetThreads(threads);
+        parameterSweep.SetDensity(density);
+        parameterSweep.SetFriction(friction);
+        parameterSweep.SetRestitution(restitution);
+        parameterSweep.SetSpeed(speed);
+        if(random > 0)
+        {
+            parameterSweep.SetRandom(random, seed);
+        }
+
+        return Sweep(parameterSweep, sweep);
+    }
+
+    HeadlessSimulation simulation(resourcesDir);
+    simulation.SetFrameRate(rate);
+    if(!simulation.SetMachineNumber(machine))
+    {
+        return 1;
+    }
+    if(regions > 0)
+    {
+        simulation.GetMachine()->SetThreads(regions);
+        simulation.Reset();
+    }
+
+    std::ofstream file;
+    if(!output.empty())
+    {
+        file.open(output);
+        if(!file)
+        {
+            std::cerr << "Unable to open " << output << std::endl;
+            return 1;
+        }
+    }
+
+    Trajectory trajectory(machine, rate);
+
+    std::chrono::duration<double> elapsed(0);
+    for(int run=0; run<runs; run++)
+    {
+        if(run > 0)
+        {
+            simulation.Reset();
+        }
+
+        // Only the first run is written, the rest are for timing
+        auto out = run == 0 && file.is_open() ? &file : nullptr;
+        auto recording = run == 0 && !record.empty() ? &trajectory : nullptr;
+
+        auto start = std::chrono::steady_clock::now();
+        simulation.Run(frames, out, recording);
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    if(!record.empty() && !trajectory.Save(record))
+    {
+        std::cerr << "Unable to write " << record << std::endl;
+        return 1;
+    }
+
+    auto total = double(frames) * runs;
+    std::cout << "machine " << machine
+              << " bodies " << simulation.GetBodyCount()
+              << " regions " << simulation.GetMachine()->GetRegionCount()
+              << " active " << simulation.GetMachine()->GetActivity().GetActiveCount()
+              << " sleeping " << simulation.GetMachine()->GetActivity().GetSleepingCount()
+              << " frames " << total
+              << " seconds " << elapsed.count()
+              << " frames/second " << (elapsed.count() > 0 ? total / elapsed.count() : 0) << std::endl;
+
+    return 0;
+}